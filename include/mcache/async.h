@@ -15,28 +15,584 @@
  * HISTORY
  *       2012-10-04 (bukovsky)
  *                  First draft.
+ *       2026-10-16 (agent)
+ *                  Futures/callbacks based client.
  */
 
 #ifndef MCACHE_ASYNC_H
 #define MCACHE_ASYNC_H
 
-// someone needs it?
+#include <mutex>
+#include <limits>
+#include <future>
+#include <memory>
+#include <utility>
+#include <exception>
+#include <type_traits>
+#include <condition_variable>
+#include <assert.h>
 
-//int x() {
-//    mc::client_t c(a, c1, c2);
-//
-//    c.response_storage = xy;
-//    const response_t &r1 = c.get(100);
-//    if (response_t::wait_for_response != r1) throw 1;
-//    if (response_t::wait_for_response != c.get(101)) throw 1;
-//    if (response_t::wait_for_response != c.get(102)) throw 1;
-//    if (response_t::wait_for_response != c.get(103)) throw 1;
-//    if (response_t::wait_for_response != c.get(104)) throw 1;
-//    if (response_t::wait_for_response != c.get(105)) throw 1;
-//    c.wait_for_response();
-//
-//}
+#include <mcache/error.h>
+#include <mcache/client.h>
+#include <mcache/proto/opts.h>
+#include <mcache/proto/response.h>
+#include <mcache/conversion.h>
+#include <mcache/fallthrough.h>
 
+namespace mc {
+namespace aux {
 
-#endif /* MCACHE_ASYNC_H */
+/** Completion callback that fulfills promise.
+ */
+template <typename value_t>
+class future_callback_t {
+public:
+    /** C'tor.
+     */
+    future_callback_t(): promise(std::make_shared<std::promise<value_t>>()) {}
+
+    /** Returns future bound to the promise.
+     */
+    std::future<value_t> get_future() { return promise->get_future();}
+
+    /** Sets the promise value or exception.
+     */
+    void operator()(std::exception_ptr error, value_t value) const {
+        if (error) promise->set_exception(error);
+        else promise->set_value(std::move(value));
+    }
+
+protected:
+    std::shared_ptr<std::promise<value_t>> promise; //!< the promise
+};
+
+/** Completion callback that fulfills promise without value.
+ */
+template <>
+class future_callback_t<void> {
+public:
+    /** C'tor.
+     */
+    future_callback_t(): promise(std::make_shared<std::promise<void>>()) {}
+
+    /** Returns future bound to the promise.
+     */
+    std::future<void> get_future() { return promise->get_future();}
+
+    /** Sets the promise or its exception.
+     */
+    void operator()(std::exception_ptr error) const {
+        if (error) promise->set_exception(error);
+        else promise->set_value();
+    }
+
+protected:
+    std::shared_ptr<std::promise<void>> promise; //!< the promise
+};
+
+} // namespace aux
+
+/** Template of class for asynchronous memcache clients. The commands return
+ * immediately and their results are delivered through futures or completion
+ * callbacks. Many commands to the same or different servers may be in flight
+ * at once and no thread is blocked while waiting for server response. The
+ * server proxies have to use connections that can carry many requests at once
+ * (see io::tcp::async_connection_t).
+ *
+ * The completion callbacks get std::exception_ptr as first argument that is
+ * empty if command succeeded. They are called from reactor thread (or from
+ * calling thread if no server is available) so they should be short and they
+ * must not throw. The invalid arguments (e.g. bad keys) are reported by
+ * exception thrown immediately from the command method.
+ *
+ * The d'tor waits for all pending commands.
+ */
+template <
+    typename pool_t,
+    typename server_proxies_t,
+    typename impl
+> class async_client_template_t {
+public:
+    // types
+    typedef impl api;
+
+    /** C'tor.
+     */
+    async_client_template_t(const std::vector<std::string> &addresses,
+                            const client_config_t ccfg = client_config_t())
+        : pool(addresses), proxies(addresses),
+          max_continues(ccfg.max_continues), h404_duration(ccfg.h404_duration),
+          pending()
+    {
+        if (!is_initialized())
+            throw error_t(err::internal_error, "mc::init() hasn't been called");
+    }
+
+    /** C'tor.
+     */
+    template <typename server_proxy_config_t>
+    async_client_template_t(const std::vector<std::string> &addresses,
+                            const server_proxy_config_t &scfg,
+                            const client_config_t ccfg = client_config_t())
+        : pool(addresses), proxies(addresses, scfg),
+          max_continues(ccfg.max_continues), h404_duration(ccfg.h404_duration),
+          pending()
+    {
+        if (!is_initialized())
+            throw error_t(err::internal_error, "mc::init() hasn't been called");
+    }
+
+    /** C'tor.
+     */
+    template <typename server_proxy_config_t, typename pool_config_t>
+    async_client_template_t(const std::vector<std::string> &addresses,
+                            const server_proxy_config_t &scfg,
+                            const pool_config_t &pcfg,
+                            const client_config_t ccfg = client_config_t())
+        : pool(addresses, pcfg), proxies(addresses, scfg),
+          max_continues(ccfg.max_continues), h404_duration(ccfg.h404_duration),
+          pending()
+    {
+        if (!is_initialized())
+            throw error_t(err::internal_error, "mc::init() hasn't been called");
+    }
+
+    /** D'tor: waits till all pending commands are finished. It must not be
+     * called from completion callback nor from other thread that the
+     * commands need to finish (e.g. the thread running the io_context the
+     * client is attached to).
+     */
+    ~async_client_template_t() {
+        std::unique_lock<std::mutex> guard(mutex);
+        finished.wait(guard, [this] { return !pending;});
+    }
+
+    // don't copy
+    async_client_template_t(const async_client_template_t &) = delete;
+    async_client_template_t &operator=(const async_client_template_t &)
+        = delete;
+
+    ////////////////////// CALLBACK MEMCACHE CLIENT API ///////////////////////
+
+    /** Call 'set' command on appropriate memcache server.
+     * @param key key for data.
+     * @param data data to store.
+     * @param opts storage commands options.
+     * @param callback void (std::exception_ptr).
+     */
+    template <typename callback_t>
+    void set(const std::string &key,
+             const std::string &data,
+             const opts_t &opts,
+             callback_t &&callback)
+    {
+        typedef typename impl::set_t::response_t response_t;
+        run(typename impl::set_t(key, data, opts), false,
+            [callback = std::forward<callback_t>(callback)]
+            (std::exception_ptr error, response_t &&response) mutable {
+                if (error) return callback(error);
+                switch (response.code()) {
+                case proto::resp::ok:
+                case proto::resp::stored: return callback(error);
+                default: return callback(make_error(response));
+                }
+            });
+    }
+
+    /** Call 'add' command on appropriate memcache server.
+     * @param key key for data.
+     * @param data data to store.
+     * @param opts storage commands options.
+     * @param callback void (std::exception_ptr, bool added).
+     */
+    template <typename callback_t>
+    void add(const std::string &key,
+             const std::string &data,
+             const opts_t &opts,
+             callback_t &&callback)
+    {
+        typedef typename impl::add_t::response_t response_t;
+        run(typename impl::add_t(key, data, opts), false,
+            [callback = std::forward<callback_t>(callback)]
+            (std::exception_ptr error, response_t &&response) mutable {
+                if (error) return callback(error, false);
+                switch (response.code()) {
+                case proto::resp::ok:
+                case proto::resp::stored: return callback(error, true);
+                case proto::resp::exists:
+                case proto::resp::not_stored: return callback(error, false);
+                default: return callback(make_error(response), false);
+                }
+            });
+    }
+
+    /** Call 'get' command on appropriate memcache server.
+     * @param key key for data.
+     * @param callback void (std::exception_ptr, result_t).
+     */
+    template <typename callback_t>
+    void get(const std::string &key, callback_t &&callback) {
+        typedef typename impl::get_t::response_t response_t;
+        run(typename impl::get_t(key), true,
+            [callback = std::forward<callback_t>(callback)]
+            (std::exception_ptr error, response_t &&response) mutable {
+                if (error) return callback(error, result_t(false));
+                switch (response.code()) {
+                case proto::resp::ok:
+                    return callback(error, result_t(response.data(),
+                                                    response.flags));
+                case proto::resp::not_found:
+                    return callback(error, result_t(false));
+                default: return callback(make_error(response), result_t(false));
+                }
+            });
+    }
+
+    /** Call 'gets' command on appropriate memcache server.
+     * @param key key for data.
+     * @param callback void (std::exception_ptr, result_t).
+     */
+    template <typename callback_t>
+    void gets(const std::string &key, callback_t &&callback) {
+        typedef typename impl::gets_t::response_t response_t;
+        run(typename impl::gets_t(key), true,
+            [callback = std::forward<callback_t>(callback)]
+            (std::exception_ptr error, response_t &&response) mutable {
+                if (error) return callback(error, result_t(false));
+                switch (response.code()) {
+                case proto::resp::ok:
+                    return callback(error, result_t(response.data(),
+                                                    response.flags,
+                                                    response.cas));
+                case proto::resp::not_found:
+                    return callback(error, result_t(false));
+                default: return callback(make_error(response), result_t(false));
+                }
+            });
+    }
+
+    /** Call 'incr' command on appropriate memcache server.
+     * @param key key for data.
+     * @param inc amount of increment.
+     * @param opts incr commands options.
+     * @param callback void (std::exception_ptr, std::pair<uint64_t, bool>).
+     */
+    template <typename callback_t>
+    void incr(const std::string &key,
+              uint64_t inc,
+              const opts_t &opts,
+              callback_t &&callback)
+    {
+        run_counter(typename impl::incr_t(key, inc, opts),
+                    std::forward<callback_t>(callback));
+    }
+
+    /** Call 'decr' command on appropriate memcache server.
+     * @param key key for data.
+     * @param dec amount of decrement.
+     * @param opts decr commands options.
+     * @param callback void (std::exception_ptr, std::pair<uint64_t, bool>).
+     */
+    template <typename callback_t>
+    void decr(const std::string &key,
+              uint64_t dec,
+              const opts_t &opts,
+              callback_t &&callback)
+    {
+        run_counter(typename impl::decr_t(key, dec, opts),
+                    std::forward<callback_t>(callback));
+    }
 
+    /** Call 'delete' command on appropriate memcache server.
+     * @param key key for data.
+     * @param callback void (std::exception_ptr, bool deleted).
+     */
+    template <typename callback_t>
+    void del(const std::string &key, callback_t &&callback) {
+        typedef typename impl::delete_t::response_t response_t;
+        run(typename impl::delete_t(key), false,
+            [callback = std::forward<callback_t>(callback)]
+            (std::exception_ptr error, response_t &&response) mutable {
+                if (error) return callback(error, false);
+                switch (response.code()) {
+                case proto::resp::ok:
+                case proto::resp::deleted: return callback(error, true);
+                case proto::resp::not_found: return callback(error, false);
+                default: return callback(make_error(response), false);
+                }
+            });
+    }
+
+    /////////////////////// FUTURE MEMCACHE CLIENT API ////////////////////////
+
+    /** Call 'set' command on appropriate memcache server.
+     */
+    std::future<void> set(const std::string &key,
+                          const std::string &data,
+                          const opts_t &opts = opts_t())
+    {
+        aux::future_callback_t<void> callback;
+        auto future = callback.get_future();
+        set(key, data, opts, std::move(callback));
+        return future;
+    }
+
+    /** Call 'add' command on appropriate memcache server.
+     */
+    std::future<bool> add(const std::string &key,
+                          const std::string &data,
+                          const opts_t &opts = opts_t())
+    {
+        aux::future_callback_t<bool> callback;
+        auto future = callback.get_future();
+        add(key, data, opts, std::move(callback));
+        return future;
+    }
+
+    /** Call 'get' command on appropriate memcache server.
+     */
+    std::future<result_t> get(const std::string &key) {
+        aux::future_callback_t<result_t> callback;
+        auto future = callback.get_future();
+        get(key, std::move(callback));
+        return future;
+    }
+
+    /** Call 'gets' command on appropriate memcache server.
+     */
+    std::future<result_t> gets(const std::string &key) {
+        aux::future_callback_t<result_t> callback;
+        auto future = callback.get_future();
+        gets(key, std::move(callback));
+        return future;
+    }
+
+    /** Call 'incr' command on appropriate memcache server.
+     */
+    std::future<std::pair<uint64_t, bool>>
+    incr(const std::string &key,
+         uint64_t inc = 1,
+         const opts_t &opts = opts_t())
+    {
+        aux::future_callback_t<std::pair<uint64_t, bool>> callback;
+        auto future = callback.get_future();
+        incr(key, inc, opts, std::move(callback));
+        return future;
+    }
+
+    /** Call 'decr' command on appropriate memcache server.
+     */
+    std::future<std::pair<uint64_t, bool>>
+    decr(const std::string &key,
+         uint64_t dec = 1,
+         const opts_t &opts = opts_t())
+    {
+        aux::future_callback_t<std::pair<uint64_t, bool>> callback;
+        auto future = callback.get_future();
+        decr(key, dec, opts, std::move(callback));
+        return future;
+    }
+
+    /** Call 'delete' command on appropriate memcache server.
+     */
+    std::future<bool> del(const std::string &key) {
+        aux::future_callback_t<bool> callback;
+        auto future = callback.get_future();
+        del(key, std::move(callback));
+        return future;
+    }
+
+    /** Returns count of commands that are in flight.
+     */
+    std::size_t in_flight() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return pending;
+    }
+
+protected:
+    /** State of one command that travels over the servers in the consistent
+     * hash ring. It is the async counterpart of client_template_t::run().
+     */
+    template <typename command_t, typename callback_t>
+    class request_t
+        : public std::enable_shared_from_this<request_t<command_t, callback_t>>
+    {
+    public:
+        // shortcuts
+        typedef typename command_t::response_t response_t;
+        typedef typename pool_t::value_type idx_t;
+
+        /** C'tor.
+         */
+        request_t(async_client_template_t *client,
+                  command_t &&command,
+                  bool h404,
+                  callback_t &&callback)
+            : client(client), command(std::move(command)), h404(h404),
+              callback(std::move(callback)),
+              iidx(client->pool.choose(this->command.key)),
+              prev(std::numeric_limits<idx_t>::max()), conts(),
+              out_of_servers(true)
+        {}
+
+        /** Sends command to next callable server or finishes the request.
+         */
+        void next() {
+            for (; (iidx != client->pool.end())
+                    && (conts < client->max_continues); ++iidx)
+            {
+                // skip previous key
+                if (*iidx == prev) continue;
+                prev = *iidx;
+
+                // check if choosed server node is dead
+                auto &server = client->proxies[*iidx];
+                if (server.callable()) {
+                    auto self = this->shared_from_this();
+                    server.async_send(command,
+                                      [self, &server] (response_t &&response) {
+                        self->handle(server, std::move(response));
+                    });
+                    return;
+                }
+
+                // can't be in for statement due to "skip previous key"
+                ++conts;
+            }
+            if (out_of_servers) {
+                return finish(std::make_exception_ptr(out_of_servers_t()),
+                              response_t(proto::resp::error));
+            }
+            finish(nullptr, response_t(proto::resp::not_found));
+        }
+
+    protected:
+        /** Processes server response.
+         */
+        template <typename server_proxy_t>
+        void handle(server_proxy_t &server, response_t &&response) {
+            switch (response.code()) {
+            case proto::resp::io_error: break;
+            case proto::resp::not_found:
+                // see client_template_t::run()
+                if (h404 && !conts
+                    && (server.lifespan() < client->h404_duration))
+                {
+                    out_of_servers = false;
+                    break;
+                }
+                MCACHE_FALLTHROUGH;
+            default: return finish(nullptr, std::move(response));
+            }
+
+            // try next server
+            ++conts;
+            ++iidx;
+            try {
+                next();
+            } catch (...) {
+                finish(std::current_exception(),
+                       response_t(proto::resp::error));
+            }
+        }
+
+        /** Calls callback and releases the request.
+         */
+        void finish(std::exception_ptr error, response_t &&response) {
+            callback(error, std::move(response));
+            client->release();
+        }
+
+        async_client_template_t *client;       //!< the client
+        command_t command;                     //!< memcache command
+        bool h404;                             //!< handle 404 for get
+        callback_t callback;                   //!< completion callback
+        typename pool_t::const_iterator iidx;  //!< current server
+        idx_t prev;                            //!< previous server
+        uint32_t conts;                        //!< count of continues
+        bool out_of_servers;                   //!< no server has responded
+    };
+
+    /** Sends command to appropriate server. The callback gets the response
+     * or the error if no server is available.
+     * @param command memcache protocol command.
+     * @param h404 handle 404 as in client_template_t::run().
+     * @param callback void (std::exception_ptr, response_t &&).
+     */
+    template <typename command_t, typename callback_t>
+    void run(command_t &&command, bool h404, callback_t &&callback) {
+        assert(mc::is_initialized());
+        typedef request_t<
+            std::decay_t<command_t>,
+            std::decay_t<callback_t>
+        > request_type;
+        acquire();
+        try {
+            proxies.eject_outliers();
+            std::make_shared<request_type>(this,
+                                           std::forward<command_t>(command),
+                                           h404,
+                                           std::forward<callback_t>(callback))
+                ->next();
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    /** Sends incr or decr command to appropriate server.
+     */
+    template <typename command_t, typename callback_t>
+    void run_counter(command_t &&command, callback_t &&callback) {
+        typedef typename std::decay_t<command_t>::response_t response_t;
+        run(std::forward<command_t>(command), false,
+            [callback = std::forward<callback_t>(callback)]
+            (std::exception_ptr error, response_t &&response) mutable {
+                if (error) return callback(error, std::make_pair(uint64_t(0), false));
+                switch (response.code()) {
+                case proto::resp::ok:
+                    return callback(error, std::make_pair(
+                                        aux::cnv<uint64_t>::as(response.data()),
+                                        true));
+                case proto::resp::not_found:
+                    return callback(error, std::make_pair(uint64_t(0), false));
+                default:
+                    return callback(make_error(response),
+                                    std::make_pair(uint64_t(0), false));
+                }
+            });
+    }
+
+    /** Converts error response to exception ptr.
+     */
+    template <typename response_t>
+    static std::exception_ptr make_error(const response_t &response) {
+        return std::make_exception_ptr(response.exception());
+    }
+
+    /** Counts new pending command.
+     */
+    void acquire() {
+        std::lock_guard<std::mutex> guard(mutex);
+        ++pending;
+    }
+
+    /** Uncounts finished command.
+     */
+    void release() {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!--pending) finished.notify_all();
+    }
+
+    pool_t pool;                       //!< idxs that represents key distribution
+    server_proxies_t proxies;          //!< i/o objects for memcache servers
+    const uint32_t max_continues;      //!< max continues in client loop
+    const seconds_t h404_duration;     //!< duration limit for handlig 404 for get
+    mutable std::mutex mutex;          //!< guards pending counter
+    std::condition_variable finished;  //!< signals that all commands finished
+    std::size_t pending;               //!< count of commands in flight
+};
+
+} // namespace mc
+
+#endif /* MCACHE_ASYNC_H */
@@ -0,0 +1,271 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Boost.Asio front-end (co_await) for asynchronous client.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_AWAITABLE_H
+#define MCACHE_AWAITABLE_H
+
+#include <memory>
+#include <utility>
+#include <exception>
+#include <assert.h>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/post.hpp>
+#ifdef BOOST_ASIO_HAS_CO_AWAIT
+#include <boost/asio/use_awaitable.hpp>
+#endif /* BOOST_ASIO_HAS_CO_AWAIT */
+
+#include <mcache/mcache.h>
+
+namespace mc {
+namespace aux {
+
+#ifdef BOOST_ASIO_HAS_CO_AWAIT
+/** Completion token used if caller does not give any: co_await.
+ */
+typedef boost::asio::use_awaitable_t<> default_token_t;
+#else /* BOOST_ASIO_HAS_CO_AWAIT */
+/** There is no default completion token without coroutines.
+ */
+class default_token_t;
+#endif /* BOOST_ASIO_HAS_CO_AWAIT */
+
+} // namespace aux
+
+/** Asynchronous client that speaks the Boost.Asio completion token language.
+ * Its sockets are driven by the caller's io_context, so the client shares
+ * executor with the rest of the application and no thread is stalled while
+ * waiting for memcache server. With C++20 coroutines the commands can be
+ * simply awaited:
+ *
+ * @code
+ * auto res = co_await client.async_get("key");
+ * @endcode
+ *
+ * Any other completion token (callback, boost::asio::use_future, ...) works
+ * too. The completion handlers are called via the handler's associated
+ * executor; the errors are delivered as std::exception_ptr (thrown from
+ * co_await).
+ *
+ * The connections keep reading their sockets (to notice closed connections
+ * early), so io_context::run() does not return while the client is alive.
+ *
+ * The d'tor waits for the commands in flight and only the attached context
+ * can finish them, so the client must not be destroyed from thread running
+ * the context while some command is in flight (it would deadlock).
+ */
+template <
+    typename pool_t,
+    typename server_proxies_t,
+    typename impl
+> class awaitable_client_template_t
+    : public async_client_template_t<pool_t, server_proxies_t, impl>
+{
+public:
+    // shortcuts
+    typedef async_client_template_t<pool_t, server_proxies_t, impl> base_t;
+    typedef std::pair<uint64_t, bool> counter_t;
+
+    /** C'tor.
+     */
+    awaitable_client_template_t(boost::asio::io_context &context,
+                                const std::vector<std::string> &addresses,
+                                const client_config_t ccfg = client_config_t())
+        : base_t(addresses, attach(context, server_proxy_config_t()), ccfg),
+          context(&context)
+    {}
+
+    /** C'tor.
+     */
+    awaitable_client_template_t(boost::asio::io_context &context,
+                                const std::vector<std::string> &addresses,
+                                const server_proxy_config_t &scfg,
+                                const client_config_t ccfg = client_config_t())
+        : base_t(addresses, attach(context, scfg), ccfg), context(&context)
+    {}
+
+    /** C'tor.
+     */
+    template <typename pool_config_t>
+    awaitable_client_template_t(boost::asio::io_context &context,
+                                const std::vector<std::string> &addresses,
+                                const server_proxy_config_t &scfg,
+                                const pool_config_t &pcfg,
+                                const client_config_t ccfg = client_config_t())
+        : base_t(addresses, attach(context, scfg), pcfg, ccfg),
+          context(&context)
+    {}
+
+    /** D'tor: checks that it does not wait for commands that can't finish.
+     */
+    ~awaitable_client_template_t() {
+        assert(!context->get_executor().running_in_this_thread()
+               || !this->in_flight());
+    }
+
+    /** Call 'set' command on appropriate memcache server.
+     * Completion signature: void (std::exception_ptr).
+     */
+    template <typename token_t = aux::default_token_t>
+    auto async_set(const std::string &key,
+                   const std::string &data,
+                   const opts_t &opts = opts_t(),
+                   token_t &&token = token_t())
+    {
+        return boost::asio::async_initiate<token_t, void (std::exception_ptr)>(
+            [this] (auto &&handler, const std::string &key,
+                    const std::string &data, const opts_t &opts) {
+                this->set(key, data, opts, bind(std::move(handler)));
+            }, token, key, data, opts);
+    }
+
+    /** Call 'add' command on appropriate memcache server.
+     * Completion signature: void (std::exception_ptr, bool).
+     */
+    template <typename token_t = aux::default_token_t>
+    auto async_add(const std::string &key,
+                   const std::string &data,
+                   const opts_t &opts = opts_t(),
+                   token_t &&token = token_t())
+    {
+        return boost::asio::async_initiate<
+            token_t, void (std::exception_ptr, bool)
+        >([this] (auto &&handler, const std::string &key,
+                  const std::string &data, const opts_t &opts) {
+            this->add(key, data, opts, bind(std::move(handler)));
+        }, token, key, data, opts);
+    }
+
+    /** Call 'get' command on appropriate memcache server.
+     * Completion signature: void (std::exception_ptr, result_t).
+     */
+    template <typename token_t = aux::default_token_t>
+    auto async_get(const std::string &key, token_t &&token = token_t()) {
+        return boost::asio::async_initiate<
+            token_t, void (std::exception_ptr, result_t)
+        >([this] (auto &&handler, const std::string &key) {
+            this->get(key, bind(std::move(handler)));
+        }, token, key);
+    }
+
+    /** Call 'gets' command on appropriate memcache server.
+     * Completion signature: void (std::exception_ptr, result_t).
+     */
+    template <typename token_t = aux::default_token_t>
+    auto async_gets(const std::string &key, token_t &&token = token_t()) {
+        return boost::asio::async_initiate<
+            token_t, void (std::exception_ptr, result_t)
+        >([this] (auto &&handler, const std::string &key) {
+            this->gets(key, bind(std::move(handler)));
+        }, token, key);
+    }
+
+    /** Call 'incr' command on appropriate memcache server.
+     * Completion signature: void (std::exception_ptr, counter_t).
+     */
+    template <typename token_t = aux::default_token_t>
+    auto async_incr(const std::string &key,
+                    uint64_t inc = 1,
+                    const opts_t &opts = opts_t(),
+                    token_t &&token = token_t())
+    {
+        return boost::asio::async_initiate<
+            token_t, void (std::exception_ptr, counter_t)
+        >([this] (auto &&handler, const std::string &key,
+                  uint64_t inc, const opts_t &opts) {
+            this->incr(key, inc, opts, bind(std::move(handler)));
+        }, token, key, inc, opts);
+    }
+
+    /** Call 'decr' command on appropriate memcache server.
+     * Completion signature: void (std::exception_ptr, counter_t).
+     */
+    template <typename token_t = aux::default_token_t>
+    auto async_decr(const std::string &key,
+                    uint64_t dec = 1,
+                    const opts_t &opts = opts_t(),
+                    token_t &&token = token_t())
+    {
+        return boost::asio::async_initiate<
+            token_t, void (std::exception_ptr, counter_t)
+        >([this] (auto &&handler, const std::string &key,
+                  uint64_t dec, const opts_t &opts) {
+            this->decr(key, dec, opts, bind(std::move(handler)));
+        }, token, key, dec, opts);
+    }
+
+    /** Call 'delete' command on appropriate memcache server.
+     * Completion signature: void (std::exception_ptr, bool).
+     */
+    template <typename token_t = aux::default_token_t>
+    auto async_del(const std::string &key, token_t &&token = token_t()) {
+        return boost::asio::async_initiate<
+            token_t, void (std::exception_ptr, bool)
+        >([this] (auto &&handler, const std::string &key) {
+            this->del(key, bind(std::move(handler)));
+        }, token, key);
+    }
+
+protected:
+    /** Returns server proxy config whose connections use given event loop.
+     */
+    static server_proxy_config_t
+    attach(boost::asio::io_context &context, server_proxy_config_t scfg) {
+        scfg.io_opts.reactor = std::make_shared<io::reactor_t>(context);
+        return scfg;
+    }
+
+    /** Makes async client callback from asio completion handler. The handler
+     * may be move only so it is shared by copies of the callback. The handler
+     * is always posted to its associated executor and the executor is kept
+     * busy till the command is finished.
+     */
+    template <typename handler_t>
+    auto bind(handler_t &&handler) const {
+        typedef std::decay_t<handler_t> handler_type;
+        auto executor = boost::asio::get_associated_executor(
+                            handler, context->get_executor());
+        auto work = boost::asio::make_work_guard(executor);
+        auto shared = std::make_shared<handler_type>(std::move(handler));
+        return [shared, work] (auto ...args) {
+            boost::asio::post(work.get_executor(),
+                              [shared, args...] () mutable {
+                std::move(*shared)(std::move(args)...);
+            });
+        };
+    }
+
+    boost::asio::io_context *context; //!< event loop of the connections
+};
+
+namespace async {
+
+/// Defines default instantiation of the awaitable client template.
+typedef mc::awaitable_client_template_t<
+            pool_t,
+            server_proxies_t,
+            api
+        > awaitable_client_t;
+
+} // namespace async
+} // namespace mc
+
+#endif /* MCACHE_AWAITABLE_H */
@@ -0,0 +1,140 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Circuit breaker of memcache server proxy.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_CIRCUIT_BREAKER_H
+#define MCACHE_CIRCUIT_BREAKER_H
+
+#include <atomic>
+#include <cstddef>
+#include <inttypes.h>
+
+#include <mcache/time-units.h>
+
+namespace mc {
+
+/** Configuration of circuit breaker (see circuit_breaker_t).
+ */
+class circuit_breaker_config_t {
+public:
+    /** C'tor.
+     */
+    circuit_breaker_config_t()
+        : window(0ms), min_requests(20), failure_rate(0.5), backoff(1s),
+          backoff_limit(60s), jitter(0.5), probes(3)
+    {}
+
+    milliseconds_t window;        //!< sliding window of failure rate (0=off)
+    uint32_t min_requests;        //!< min # of requests in window to trip
+    double failure_rate;          //!< failure rate that trips the breaker
+    milliseconds_t backoff;       //!< length of the first open state
+    milliseconds_t backoff_limit; //!< max length of open state
+    double jitter;                //!< random part of open state (0..1)
+    uint32_t probes;              //!< # of successful probes that close it
+};
+
+/** Circuit breaker state machine. It lives in the memory shared by all
+ * threads (or processes) that talk to the server, so it consists of atomics
+ * only and the transitions are claimed by compare and swap.
+ *
+ * The closed breaker lets all requests through and counts their results in
+ * sliding window (ring of buckets). Once the window holds at least
+ * min_requests requests and failure_rate of them failed the breaker opens.
+ *
+ * The open breaker refuses the requests for the backoff period that doubles
+ * with each consecutive opening (up to backoff_limit) and is shortened by
+ * random jitter, so the processes that have seen the server fail at once do
+ * not come back at once.
+ *
+ * Then the breaker gets half open and lets given count of probe requests
+ * through. If they all succeed the breaker closes, the first failure opens
+ * it again (with doubled backoff).
+ */
+class circuit_breaker_t {
+public:
+    /** States of breaker.
+     */
+    enum state_t: uint32_t {
+        closed,    //!< requests pass
+        open,      //!< requests are refused
+        half_open, //!< probe requests pass
+        tripping,  //!< transition to open state is in progress
+        closing    //!< transition to closed state is in progress
+    };
+
+    /** Result of recorded request.
+     */
+    enum transition_t {
+        none,      //!< state not changed
+        tripped,   //!< breaker has been opened
+        recovered  //!< breaker has been closed
+    };
+
+    /// count of buckets in sliding window
+    static constexpr std::size_t buckets = 10;
+
+    /** C'tor.
+     */
+    circuit_breaker_t();
+
+    /** Returns true if request can be sent to server.
+     */
+    bool allow(const circuit_breaker_config_t &cfg, time_point_t now);
+
+    /** Records the result of request sent to server.
+     */
+    transition_t record(const circuit_breaker_config_t &cfg,
+                        time_point_t now,
+                        bool success);
+
+    /** Returns current state of breaker.
+     */
+    state_t state() const { return static_cast<state_t>(current.load());}
+
+    /** Returns time when breaker has been opened last time.
+     */
+    time_point_t opened() const { return since.load();}
+
+    /** Returns time when open breaker gets half open.
+     */
+    time_point_t retry() const { return until.load();}
+
+protected:
+    /** Opens breaker if it is in given state.
+     */
+    bool trip(const circuit_breaker_config_t &cfg, time_point_t now,
+              uint32_t from);
+
+    /** Returns randomized length of open state.
+     */
+    milliseconds_t backoff(const circuit_breaker_config_t &cfg) const;
+
+    std::atomic<uint32_t> current;   //!< state of breaker
+    std::atomic<uint32_t> trips;     //!< count of consecutive openings
+    std::atomic<uint32_t> probes;    //!< probes let through in half open
+    std::atomic<uint32_t> passed;    //!< succeeded probes in half open
+    std::atomic<time_point_t> since; //!< when breaker has been opened
+    std::atomic<time_point_t> until; //!< end of open state or probing round
+    //! sliding window of results, each bucket packs the index of slice of
+    //! time with counts of succeeded and failed requests into one word
+    std::atomic<uint64_t> window[buckets];
+};
+
+} // namespace mc
+
+#endif /* MCACHE_CIRCUIT_BREAKER_H */
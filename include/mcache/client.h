@@ -20,10 +20,15 @@
 #ifndef MCACHE_CLIENT_H
 #define MCACHE_CLIENT_H
 
+#include <map>
+#include <cmath>
 #include <string>
 #include <vector>
+#include <mutex>
 #include <limits>
+#include <memory>
 #include <iterator>
+#include <functional>
 #include <algorithm>
 #include <assert.h>
 
@@ -33,6 +38,7 @@
 #include <mcache/conversion.h>
 #include <mcache/fallthrough.h>
 #include <mcache/time-units.h>
+#include <mcache/health-checker.h>
 
 namespace mc {
 
@@ -43,6 +49,21 @@ using proto::opts_t;
  */
 bool is_initialized();
 
+namespace aux {
+
+/** Returns key of multi command input.
+ */
+inline const std::string &multi_key(const std::string &key) { return key;}
+
+/** Returns key of multi command input.
+ */
+template <typename value_t>
+const std::string &multi_key(const std::pair<std::string, value_t> &item) {
+    return item.first;
+}
+
+} // namespace aux
+
 /** Result of all get commands.
  */
 class result_t {
@@ -95,25 +116,39 @@ template <> inline std::string result_t::as<std::string>() const { return data;}
 
 #endif // MCACHE_DISABLE_SERIALIZATION_API
 
+/** Result of multi get commands: data for the keys that have been found.
+ */
+typedef std::map<std::string, result_t> results_t;
+
+/** Result of multi storage commands: errors for the keys that have not been
+ * processed.
+ */
+typedef std::map<std::string, proto::error_t> failures_t;
+
 /** Configuration of the client class.
  */
 class client_config_t {
 public:
     client_config_t(uint32_t max_continues = 3)
-        : max_continues(max_continues), h404_duration(300)
+        : max_continues(max_continues), h404_duration(300), load_bound(0),
+          health_check(0)
     {}
 
     [[deprecated("give std::chrono::seconds as second argument")]]
     client_config_t(uint32_t max_continues, int64_t h404_duration)
-        : max_continues(max_continues), h404_duration(h404_duration)
+        : max_continues(max_continues), h404_duration(h404_duration),
+          load_bound(0), health_check(0)
     {}
 
     client_config_t(uint32_t max_continues, seconds_t h404_duration)
-        : max_continues(max_continues), h404_duration(h404_duration)
+        : max_continues(max_continues), h404_duration(h404_duration),
+          load_bound(0), health_check(0)
     {}
 
-    uint32_t max_continues;  //!< max continues in client loop
-    seconds_t h404_duration; //!< duration limit for handlig 404 for get
+    uint32_t max_continues;      //!< max continues in client loop
+    seconds_t h404_duration;     //!< duration limit for handlig 404 for get
+    double load_bound;           //!< epsilon of bounded loads (0 = off)
+    milliseconds_t health_check; //!< period of dead server probes (0 = off)
 };
 
 /** Template of class for memcache clients.
@@ -131,11 +166,15 @@ public:
      */
     client_template_t(const std::vector<std::string> &addresses,
                       const client_config_t ccfg = client_config_t())
-        : pool(addresses), proxies(addresses),
-          max_continues(ccfg.max_continues), h404_duration(ccfg.h404_duration)
+        : make_pool(pool_factory()),
+          snapshot(std::make_shared<snapshot_t>(make_pool(addresses),
+                                                addresses)),
+          max_continues(ccfg.max_continues), h404_duration(ccfg.h404_duration),
+          load_bound(ccfg.load_bound), health_checker()
     {
         if (!is_initialized())
             throw error_t(err::internal_error, "mc::init() hasn't been called");
+        start_health_checker(ccfg.health_check);
     }
 
     /** C'tor.
@@ -144,11 +183,15 @@ public:
     client_template_t(const std::vector<std::string> &addresses,
                       const server_proxy_config_t &scfg,
                       const client_config_t ccfg = client_config_t())
-        : pool(addresses), proxies(addresses, scfg),
-          max_continues(ccfg.max_continues), h404_duration(ccfg.h404_duration)
+        : make_pool(pool_factory()),
+          snapshot(std::make_shared<snapshot_t>(make_pool(addresses),
+                                                addresses, scfg)),
+          max_continues(ccfg.max_continues), h404_duration(ccfg.h404_duration),
+          load_bound(ccfg.load_bound), health_checker()
     {
         if (!is_initialized())
             throw error_t(err::internal_error, "mc::init() hasn't been called");
+        start_health_checker(ccfg.health_check);
     }
 
     /** C'tor.
@@ -158,11 +201,15 @@ public:
                       const server_proxy_config_t &scfg,
                       const pool_config_t &pcfg,
                       const client_config_t ccfg = client_config_t())
-        : pool(addresses, pcfg), proxies(addresses, scfg),
-          max_continues(ccfg.max_continues), h404_duration(ccfg.h404_duration)
+        : make_pool(pool_factory(pcfg)),
+          snapshot(std::make_shared<snapshot_t>(make_pool(addresses),
+                                                addresses, scfg)),
+          max_continues(ccfg.max_continues), h404_duration(ccfg.h404_duration),
+          load_bound(ccfg.load_bound), health_checker()
     {
         if (!is_initialized())
             throw error_t(err::internal_error, "mc::init() hasn't been called");
+        start_health_checker(ccfg.health_check);
     }
 
     // don't copy
@@ -318,6 +365,56 @@ public:
         }
     }
 
+    /** Call 'set' command for many key-value pairs. The pairs are split by
+     * the servers and each server gets all its pairs in one batch. The
+     * binary protocol uses quiet commands so the server responds only the
+     * failures and the batch costs one round trip per server.
+     * @param items key-value pairs to store.
+     * @param opts storage commands options.
+     * @return errors for keys that have not been stored.
+     */
+    failures_t
+    set_multi(const std::vector<std::pair<std::string, std::string>> &items,
+              const opts_t &opts = opts_t())
+    {
+        return run_multi_storage<typename impl::set_multi_t>(
+            items, opts, proto::resp::stored
+        );
+    }
+
+    /** Call 'add' command for many key-value pairs. See set_multi() for
+     * details.
+     * @param items key-value pairs to store.
+     * @param opts storage commands options.
+     * @return errors for keys that have not been added.
+     */
+    failures_t
+    add_multi(const std::vector<std::pair<std::string, std::string>> &items,
+              const opts_t &opts = opts_t())
+    {
+        return run_multi_storage<typename impl::add_multi_t>(
+            items, opts, proto::resp::stored
+        );
+    }
+
+    /** Call 'delete' command for many keys. See set_multi() for details.
+     * @param keys keys to delete.
+     * @return errors for keys that have not been deleted.
+     */
+    failures_t delete_multi(const std::vector<std::string> &keys) {
+        typedef typename impl::delete_multi_t command_t;
+        failures_t failures;
+        run_multi(keys,
+                  [] (const std::vector<std::string> &keys) {
+                      return command_t(keys);
+                  },
+                  [&] (const typename command_t::response_t &response) {
+                      collect_failures(response, proto::resp::deleted,
+                                       failures);
+                  });
+        return failures;
+    }
+
 #if __cplusplus >= 201103L
     /** Apply functor to variable in memcache
      * @param key key for data
@@ -382,6 +479,62 @@ public:
         }
     }
 
+    /** Call 'get' command for many keys. The keys are split by the servers
+     * and each server gets all its keys in one batch so the whole call costs
+     * one round trip per server. If server fails the keys are sent to the
+     * neighbour servers as in the case of single key get command.
+     * @param keys keys for data.
+     * @return data for keys that have been found.
+     */
+    results_t get_multi(const std::vector<std::string> &keys) {
+        results_t results;
+        run_multi(keys,
+                  [] (const std::vector<std::string> &keys) {
+                      return typename impl::get_multi_t(keys);
+                  },
+                  [&] (const typename impl::get_multi_t::response_t &response) {
+                      for (auto &item: response.items) {
+                          switch (item.code()) {
+                          case proto::resp::ok:
+                              results.emplace(item.key,
+                                              result_t(item.data(),
+                                                       item.flags));
+                              break;
+                          case proto::resp::not_found: break;
+                          default: throw item.exception();
+                          }
+                      }
+                  });
+        return results;
+    }
+
+    /** Call 'gets' command for many keys. See get_multi() for details.
+     * @param keys keys for data.
+     * @return data and cas identifiers for keys that have been found.
+     */
+    results_t gets_multi(const std::vector<std::string> &keys) {
+        results_t results;
+        run_multi(keys,
+                  [] (const std::vector<std::string> &keys) {
+                      return typename impl::gets_multi_t(keys);
+                  },
+                  [&] (const typename impl::gets_multi_t::response_t &response) {
+                      for (auto &item: response.items) {
+                          switch (item.code()) {
+                          case proto::resp::ok:
+                              results.emplace(item.key,
+                                              result_t(item.data(),
+                                                       item.flags,
+                                                       item.cas));
+                              break;
+                          case proto::resp::not_found: break;
+                          default: throw item.exception();
+                          }
+                      }
+                  });
+        return results;
+    }
+
     /** Call 'incr' command on appropriate memcache server.
      * @param key key for data.
      * @param inc amount of increment.
@@ -595,13 +748,59 @@ public:
     /** Dumps current state of pool to string.
      */
     std::string dump() const {
+        auto current = std::atomic_load(&snapshot);
         std::vector<std::string> proxies_state;
-        for (auto &proxy: proxies)
+        for (auto &proxy: current->proxies)
             proxies_state.push_back(proxy.state());
-        return pool.dump(proxies_state);
+        return current->pool.dump(proxies_state);
+    }
+
+    /** Replaces the list of servers. The new key distribution and the proxies
+     * of new servers are made aside and then published at once; the commands
+     * in flight finish with the previous servers. The servers that remain in
+     * the list keep their proxies (state and pooled connections).
+     * @param addresses new list of server addresses.
+     */
+    void update_servers(const std::vector<std::string> &addresses) {
+        std::lock_guard<std::mutex> guard(update_mutex);
+        publish(make_pool(addresses), addresses);
+    }
+
+    /** Replaces the list of servers and the pool config (e.g. when the config
+     * holds per server weights). See update_servers(addresses).
+     * @param addresses new list of server addresses.
+     * @param pcfg new pool config.
+     */
+    template <typename pool_config_t>
+    void update_servers(const std::vector<std::string> &addresses,
+                        const pool_config_t &pcfg)
+    {
+        std::lock_guard<std::mutex> guard(update_mutex);
+        auto factory = pool_factory(pcfg);
+        publish(factory(addresses), addresses);
+        make_pool = std::move(factory);
     }
 
 protected:
+    /** Servers used by the client: distribution of keys and server proxies.
+     * The commands hold the snapshot that has been current when they started.
+     */
+    class snapshot_t {
+    public:
+        /** C'tor.
+         */
+        template <typename... args_t>
+        snapshot_t(pool_t &&pool,
+                   const std::vector<std::string> &addresses,
+                   args_t &&...args)
+            : pool(std::move(pool)),
+              proxies(addresses, std::forward<args_t>(args)...)
+        {}
+
+        pool_t pool;              //!< idxs that represents key distribution
+        server_proxies_t proxies; //!< i/o objects for memcache servers
+    };
+
     /** Serialize command and send it to appropriate server.
      * @param command memcache protocol command.
      * @return memcache server response.
@@ -610,6 +809,10 @@ protected:
     typename command_t::response_t
     run(const command_t &command, bool h404 = false) {
         assert(mc::is_initialized());
+        auto current = std::atomic_load(&snapshot);
+        auto &pool = current->pool;
+        auto &proxies = current->proxies;
+        proxies.eject_outliers();
         // we will never have this count of servers
         typename pool_t::value_type
             prev = std::numeric_limits<typename pool_t::value_type>::max();
@@ -619,7 +822,7 @@ protected:
 
         // find callable server for given key
         for (typename pool_t::const_iterator
-                iidx = pool.choose(command.key),
+                iidx = choose(*current, command.key),
                 eidx = pool.end();
                 (iidx != eidx) && (conts < max_continues); ++iidx)
         {
@@ -661,6 +864,8 @@ protected:
     template <typename command_t>
     std::vector<typename command_t::response_t>
     run_all(const command_t &command) {
+        auto current = std::atomic_load(&snapshot);
+        auto &proxies = current->proxies;
         std::vector<typename command_t::response_t> responses;
         for (typename server_proxies_t::iterator
                 iserver = proxies.begin(),
@@ -683,10 +888,241 @@ protected:
         return responses;
     }
 
-    pool_t pool;                   //!< idxs that represents key distribution
-    server_proxies_t proxies;      //!< i/o objects for memcache servers
-    const uint32_t max_continues;  //!< max continues in client loop
-    const seconds_t h404_duration; //!< duration limit for handlig 404 for get
+    /** Split inputs by the servers and send all inputs for one server in one
+     * batch command. If server fails then its inputs are distributed to the
+     * neighbour servers.
+     * @param inputs keys or key-value pairs.
+     * @param make_command creates batch command from inputs.
+     * @param callback called for each successful batch response.
+     */
+    template <typename input_t, typename make_command_t, typename callback_t>
+    void run_multi(const std::vector<input_t> &inputs,
+                   make_command_t &&make_command,
+                   callback_t &&callback)
+    {
+        assert(mc::is_initialized());
+        auto current = std::atomic_load(&snapshot);
+        auto &proxies = current->proxies;
+        proxies.eject_outliers();
+        // state of servers: -1 => unknown, 0 => unusable, 1 => usable
+        std::vector<int8_t> usable(std::distance(proxies.begin(),
+                                                 proxies.end()), -1);
+        // indices of inputs waiting for server
+        std::vector<std::size_t> pending(inputs.size());
+        for (std::size_t i = 0; i < inputs.size(); ++i) pending[i] = i;
+
+        while (!pending.empty()) {
+            // split inputs by the first usable server in the ring
+            typedef typename pool_t::value_type idx_t;
+            std::map<idx_t, std::vector<input_t>> batches;
+            std::map<idx_t, std::vector<std::size_t>> indices;
+            for (std::size_t i: pending) {
+                idx_t idx = choose_usable(*current, aux::multi_key(inputs[i]),
+                                          usable);
+                batches[idx].push_back(inputs[i]);
+                indices[idx].push_back(i);
+            }
+            pending.clear();
+
+            // send batches to servers and wait till responses arrive
+            for (auto &batch: batches) {
+                auto response = proxies[batch.first].send(
+                    make_command(batch.second)
+                );
+                switch (response.code()) {
+                case proto::resp::io_error:
+                    // try the inputs on next server in the ring
+                    usable[batch.first] = 0;
+                    pending.insert(pending.end(),
+                                   indices[batch.first].begin(),
+                                   indices[batch.first].end());
+                    break;
+                case proto::resp::ok:
+                    callback(response);
+                    break;
+                default: throw response.exception();
+                }
+            }
+        }
+    }
+
+    /** Sends batch storage commands and collects failures.
+     * @param items key-value pairs to store.
+     * @param opts storage commands options.
+     * @param success the response code that means success.
+     */
+    template <typename command_t>
+    failures_t
+    run_multi_storage(const std::vector<
+                          std::pair<std::string, std::string>
+                      > &items,
+                      const opts_t &opts,
+                      proto::resp::response_code_t success)
+    {
+        typedef std::vector<std::pair<std::string, std::string>> items_t;
+        failures_t failures;
+        run_multi(items,
+                  [&] (const items_t &items) {
+                      return command_t(items, opts);
+                  },
+                  [&] (const typename command_t::response_t &response) {
+                      collect_failures(response, success, failures);
+                  });
+        return failures;
+    }
+
+    /** Stores errors of failed items of batch response.
+     * @param response batch response.
+     * @param success the response code that means success.
+     * @param failures storage for errors.
+     */
+    template <typename response_t>
+    static void collect_failures(const response_t &response,
+                                 proto::resp::response_code_t success,
+                                 failures_t &failures)
+    {
+        for (auto &item: response.items) {
+            if ((item.code() == success) || (item.code() == proto::resp::ok))
+                continue;
+            failures.emplace(item.key, item.exception());
+        }
+    }
+
+    /** Returns iterator to the server for given key. If bounded loads are
+     * enabled (Mirrokni et al.) the servers with load over the capacity
+     * ceil((1 + load_bound) * (total load + 1) / servers) are passed over, so
+     * the hot keys spill to the next servers in the ring.
+     * @param current the servers.
+     * @param key the key.
+     */
+    typename pool_t::const_iterator
+    choose(snapshot_t &current, const std::string &key) {
+        auto iidx = current.pool.choose(key);
+        if (load_bound <= 0) return iidx;
+
+        // the capacity is at least one so the idle server is never passed
+        double capacity = 0;
+        for (auto jidx = iidx, eidx = current.pool.end(); jidx != eidx; ++jidx)
+        {
+            uint32_t load = current.proxies[*jidx].load();
+            if (!load) return jidx;
+            if (!capacity) {
+                capacity = std::ceil((1 + load_bound)
+                                     * double(current.proxies.load() + 1)
+                                     / double(current.proxies.size()));
+            }
+            if (load < capacity) return jidx;
+        }
+        return iidx;
+    }
+
+    /** Returns index of first usable server in the ring for given key.
+     * @param current the servers.
+     * @param key the key.
+     * @param usable cached states of servers.
+     */
+    typename pool_t::value_type
+    choose_usable(snapshot_t &current,
+                  const std::string &key,
+                  std::vector<int8_t> &usable)
+    {
+        auto &pool = current.pool;
+        auto &proxies = current.proxies;
+        // we will never have this count of servers
+        typename pool_t::value_type
+            prev = std::numeric_limits<typename pool_t::value_type>::max();
+        // count of consequently continues
+        uint32_t conts = 0;
+
+        // find callable server for given key
+        for (typename pool_t::const_iterator
+                iidx = pool.choose(key),
+                eidx = pool.end();
+                (iidx != eidx) && (conts < max_continues); ++iidx)
+        {
+            // skip previous key
+            if (*iidx == prev) continue;
+            prev = *iidx;
+
+            // ask server whether it is callable only once per call
+            if (usable[*iidx] < 0) usable[*iidx] = proxies[*iidx].callable();
+            if (usable[*iidx]) return *iidx;
+            ++conts;
+        }
+        throw out_of_servers_t();
+    }
+
+    /** Makes pool for given addresses.
+     */
+    typedef std::function<pool_t (const std::vector<std::string> &)>
+            pool_factory_t;
+
+    /** Returns factory for pools with default config.
+     */
+    static pool_factory_t pool_factory() {
+        return [] (const std::vector<std::string> &addresses) {
+            return pool_t(addresses);
+        };
+    }
+
+    /** Returns factory for pools with given config.
+     */
+    template <typename pool_config_t>
+    static pool_factory_t pool_factory(const pool_config_t &pcfg) {
+        return [pcfg] (const std::vector<std::string> &addresses) {
+            return pool_t(addresses, pcfg);
+        };
+    }
+
+    /** Makes new snapshot that reuses proxies of current one and publishes
+     * it. The caller must hold the update_mutex.
+     */
+    void publish(pool_t &&pool, const std::vector<std::string> &addresses) {
+        auto current = std::atomic_load(&snapshot);
+        auto next = std::make_shared<snapshot_t>(std::move(pool), addresses,
+                                                 current->proxies);
+        std::atomic_store(&snapshot, std::move(next));
+    }
+
+    /** Starts thread that probes the dead servers if interval is not zero.
+     */
+    void start_health_checker(milliseconds_t interval) {
+        if (!interval.count()) return;
+        health_checker = std::make_unique<health_checker_t>(
+            interval,
+            [this, interval] { check_health(interval);});
+    }
+
+    /** Probes the dead servers one by one. Each probe can block for the
+     * connect timeout, so the servers that wait for their probe are watched
+     * again before it; otherwise the callers would take over the probing of
+     * servers at the end of long round.
+     */
+    void check_health(milliseconds_t interval) {
+        auto current = std::atomic_load(&snapshot);
+        auto &proxies = current->proxies;
+        for (auto iproxy = proxies.begin(); iproxy != proxies.end(); ++iproxy)
+        {
+            if (!iproxy->is_dead()) continue;
+            auto until = std::chrono::system_clock::now() + 3 * interval;
+            for (auto iwaiting = iproxy; iwaiting != proxies.end(); ++iwaiting)
+                iwaiting->watch(until);
+            iproxy->check_health(typename api::version_t(), interval);
+        }
+
+        // the alive servers are watched too since they can die meanwhile
+        auto until = std::chrono::system_clock::now() + 3 * interval;
+        for (auto &proxy: proxies) proxy.watch(until);
+    }
+
+    pool_factory_t make_pool;             //!< makes pool for new servers
+    std::shared_ptr<snapshot_t> snapshot; //!< current servers
+    std::mutex update_mutex;              //!< serializes server updates
+    const uint32_t max_continues;         //!< max continues in client loop
+    const seconds_t h404_duration;        //!< duration limit for handlig 404
+    const double load_bound;              //!< epsilon of bounded loads
+    // must be the last one: it is stopped before the servers are destroyed
+    std::unique_ptr<health_checker_t> health_checker; //!< dead server prober
 };
 
 } // namespace mc
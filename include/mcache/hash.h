@@ -24,6 +24,10 @@
 #include <mcache/hash/murmur3.h>
 #include <mcache/hash/city.h>
 #include <mcache/hash/spooky.h>
+#include <mcache/hash/md5.h>
+#include <mcache/hash/xxhash.h>
+#include <mcache/hash/crc32c.h>
+#include <mcache/hash/mix.h>
 
 namespace mc {
 
@@ -57,6 +57,29 @@ public:
     }
 };
 
+/** Geoff Pike and Jyrki Alakuijala 64bit hash function.
+ * @param buf pointer to data buffer.
+ * @param size size of data.
+ * @param seed seed for hash algorithm.
+ * @return calculated 64bit hash.
+ */
+uint64_t city64(const void *buf, std::size_t size, uint64_t seed = 0);
+
+/** Type wrapper for 64bit city hash function.
+ */
+class city64_t {
+public:
+    /** Geoff Pike and Jyrki Alakuijala 64bit hash function.
+     * @param str data buffer.
+     * @param seed seed for hash algorithm.
+     * @return calculated 64bit hash.
+     */
+    inline uint64_t
+    operator()(const std::string &str, uint64_t seed = 0) const {
+        return city64(str.data(), str.size(), seed);
+    }
+};
+
 } // namespace mc
 
 #endif /* MCACHE_HASH_CITY_H */
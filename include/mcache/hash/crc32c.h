@@ -0,0 +1,74 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      CRC32C (Castagnoli) hash function.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_HASH_CRC32C_H
+#define MCACHE_HASH_CRC32C_H
+
+#include <stdint.h>
+#include <string>
+
+namespace mc {
+
+/** CRC32C checksum (iSCSI polynomial). It uses the SSE4.2 crc32 instruction
+ * if the cpu supports it and the table driven implementation otherwise.
+ * @param buf pointer to data buffer.
+ * @param size size of data.
+ * @param seed crc of preceding data (allows incremental computation).
+ * @return calculated 32bit checksum.
+ */
+uint32_t crc32c(const void *buf, std::size_t size, uint32_t seed = 0);
+
+/** CRC32C checksum.
+ * @param str data buffer.
+ * @param seed crc of preceding data.
+ * @return calculated 32bit checksum.
+ */
+inline uint32_t crc32c(const std::string &str, uint32_t seed = 0) {
+    return crc32c(str.data(), str.size(), seed);
+}
+
+/** Returns true if crc32c() uses the hardware instruction.
+ */
+bool crc32c_hardware();
+
+/** Type wrapper for crc32c hash function. The crc is linear function of the
+ * data so keys differing in few bits would land close to each other on the
+ * ring; the crc is therefore finalized by murmur3 avalanche.
+ */
+class crc32c_t {
+public:
+    /** CRC32C hash function.
+     * @param str data buffer.
+     * @param seed seed for hash algorithm.
+     * @return calculated 32bit hash.
+     */
+    inline uint32_t
+    operator()(const std::string &str, uint32_t seed = 0) const {
+        uint32_t hash = crc32c(str.data(), str.size(), seed);
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6b;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35;
+        return hash ^ (hash >> 16);
+    }
+};
+
+} // namespace mc
+
+#endif /* MCACHE_HASH_CRC32C_H */
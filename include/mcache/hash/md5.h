@@ -0,0 +1,75 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      MD5 hash function (needed by ketama).
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_HASH_MD5_H
+#define MCACHE_HASH_MD5_H
+
+#include <stdint.h>
+#include <string>
+
+namespace mc {
+
+/** MD5 digest (RFC 1321).
+ * @param buf pointer to data buffer.
+ * @param size size of data.
+ * @param digest output 16 bytes long digest.
+ */
+void md5(const void *buf, std::size_t size, uint8_t digest[16]);
+
+/** Returns one of four 32bit ketama points stored in MD5 digest.
+ * @param digest MD5 digest.
+ * @param idx index of point (0..3).
+ */
+inline uint32_t ketama_point(const uint8_t digest[16], unsigned idx) {
+    return (uint32_t(digest[3 + idx * 4]) << 24)
+         | (uint32_t(digest[2 + idx * 4]) << 16)
+         | (uint32_t(digest[1 + idx * 4]) << 8)
+         | uint32_t(digest[idx * 4]);
+}
+
+/** Ketama hash function: the first point of MD5 digest.
+ * @param buf pointer to data buffer.
+ * @param size size of data.
+ * @return calculated 32bit hash.
+ */
+inline uint32_t ketama(const void *buf, std::size_t size) {
+    uint8_t digest[16];
+    md5(buf, size, digest);
+    return ketama_point(digest, 0);
+}
+
+/** Type wrapper for ketama hash function.
+ */
+class ketama_t {
+public:
+    /** Ketama hash function. The ketama has no seed so the seed is mixed to
+     * the hash afterwards.
+     * @param str data buffer.
+     * @param seed seed for hash algorithm.
+     * @return calculated 32bit hash.
+     */
+    inline uint32_t
+    operator()(const std::string &str, uint32_t seed = 0) const {
+        return ketama(str.data(), str.size()) ^ seed;
+    }
+};
+
+} // namespace mc
+
+#endif /* MCACHE_HASH_MD5_H */
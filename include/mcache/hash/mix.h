@@ -0,0 +1,41 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Integer mixing function.
+ *
+ * LICENSE          See COPYING
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_HASH_MIX_H
+#define MCACHE_HASH_MIX_H
+
+#include <stdint.h>
+
+namespace mc {
+
+/** Spreads bits of value over whole 64 bits (splitmix64 finalizer). It is
+ * cheap way to derive more hashes from one hash of the key.
+ * @param value some integer (e.g. 32bit hash).
+ * @return mixed 64bit value.
+ */
+inline uint64_t mix64(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+} // namespace mc
+
+#endif /* MCACHE_HASH_MIX_H */
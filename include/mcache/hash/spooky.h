@@ -57,6 +57,29 @@ public:
     }
 };
 
+/** Bob Jenkins spooky V2 64bit hash function.
+ * @param buf pointer to data buffer.
+ * @param size size of data.
+ * @param seed seed for hash algorithm.
+ * @return calculated 64bit hash.
+ */
+uint64_t spooky64(const void *buf, std::size_t size, uint64_t seed = 0);
+
+/** Type wrapper for 64bit spooky hash function.
+ */
+class spooky64_t {
+public:
+    /** Bob Jenkins spooky V2 64bit hash function.
+     * @param str data buffer.
+     * @param seed seed for hash algorithm.
+     * @return calculated 64bit hash.
+     */
+    inline uint64_t
+    operator()(const std::string &str, uint64_t seed = 0) const {
+        return spooky64(str.data(), str.size(), seed);
+    }
+};
+
 } // namespace mc
 
 #endif /* MCACHE_HASH_SPOOKY_H */
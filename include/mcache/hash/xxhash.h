@@ -0,0 +1,79 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      XXH3 (64bit) hash function by Yann Collet.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_HASH_XXHASH_H
+#define MCACHE_HASH_XXHASH_H
+
+#include <stdint.h>
+#include <string>
+
+namespace mc {
+
+/** XXH3 64bit hash function (XXH3_64bits_withSeed() compatible).
+ * @param buf pointer to data buffer.
+ * @param size size of data.
+ * @param seed seed for hash algorithm.
+ * @return calculated 64bit hash.
+ */
+uint64_t xxh3(const void *buf, std::size_t size, uint64_t seed = 0);
+
+/** XXH3 64bit hash function.
+ * @param str data buffer.
+ * @param seed seed for hash algorithm.
+ * @return calculated 64bit hash.
+ */
+inline uint64_t xxh3(const std::string &str, uint64_t seed = 0) {
+    return xxh3(str.data(), str.size(), seed);
+}
+
+/** Type wrapper for xxh3 hash function.
+ */
+class xxh3_t {
+public:
+    /** XXH3 hash function folded to 32 bits.
+     * @param str data buffer.
+     * @param seed seed for hash algorithm.
+     * @return calculated 32bit hash.
+     */
+    inline uint32_t
+    operator()(const std::string &str, uint32_t seed = 0) const {
+        uint64_t hash = xxh3(str.data(), str.size(), seed);
+        return static_cast<uint32_t>(hash ^ (hash >> 32));
+    }
+};
+
+/** Type wrapper for xxh3 hash function that keeps all 64 bits, for the
+ * rings with 64bit hash space (see flat_consistent_hashing_pool_t).
+ */
+class xxh3_64_t {
+public:
+    /** XXH3 hash function.
+     * @param str data buffer.
+     * @param seed seed for hash algorithm.
+     * @return calculated 64bit hash.
+     */
+    inline uint64_t
+    operator()(const std::string &str, uint64_t seed = 0) const {
+        return xxh3(str.data(), str.size(), seed);
+    }
+};
+
+} // namespace mc
+
+#endif /* MCACHE_HASH_XXHASH_H */
@@ -0,0 +1,85 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Background health checker of memcache servers.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_HEALTH_CHECKER_H
+#define MCACHE_HEALTH_CHECKER_H
+
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+#include <mcache/time-units.h>
+
+namespace mc {
+
+/** Thread that calls given check function once per interval till it is
+ * destroyed. The client uses it to probe the dead servers out of the
+ * request path (see server_proxy_t::check_health()). The thread is started
+ * again in the child after fork() (e.g. the ipc clients are created before
+ * the workers are forked).
+ */
+class health_checker_t {
+public:
+    /// the check function
+    typedef std::function<void ()> check_t;
+
+    /** C'tor. Starts the thread.
+     * @param interval how long the thread sleeps between checks.
+     * @param check the check function.
+     */
+    health_checker_t(milliseconds_t interval, check_t check);
+
+    /** D'tor. Stops the thread (waits for running check).
+     */
+    ~health_checker_t();
+
+    // don't copy
+    health_checker_t(const health_checker_t &) = delete;
+    health_checker_t &operator=(const health_checker_t &) = delete;
+
+protected:
+    /** Body of thread.
+     */
+    void run();
+
+    /** Locks the checkers so that no one is forked in the middle of change.
+     */
+    static void prepare_fork();
+
+    /** Unlocks the checkers in parent process.
+     */
+    static void parent_fork();
+
+    /** Starts threads of the checkers in child process (the threads of
+     * parent do not exist there).
+     */
+    static void child_fork();
+
+    milliseconds_t interval;         //!< sleep between checks
+    check_t check;                   //!< the check function
+    std::mutex mutex;                //!< guards the stopping flag
+    std::condition_variable wakeup;  //!< signals the stopping
+    bool stopping;                   //!< true if thread should stop
+    std::thread thread;              //!< the checker thread
+};
+
+} // namespace mc
+
+#endif /* MCACHE_HEALTH_CHECKER_H */
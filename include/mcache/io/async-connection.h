@@ -0,0 +1,120 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Async I/O object for communication with memcache server.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_IO_ASYNC_CONNECTION_H
+#define MCACHE_IO_ASYNC_CONNECTION_H
+
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <exception>
+#include <functional>
+
+#include <mcache/io/opts.h>
+#include <mcache/io/buffer.h>
+
+namespace mc {
+namespace io {
+namespace tcp {
+
+/** I/O object that holds one tcp socket to memcache server and allows many
+ * requests to be in flight at once. The socket is driven by reactor (see
+ * opts_t::reactor) so no thread is blocked while waiting for response.
+ *
+ * Requests are written in order as they come and as many of them as are
+ * waiting are written at once (pipelining). The responses of plain requests
+ * are dispatched in the same order (the memcache server responds in order).
+ * The tagged requests (see tag_t) own range of opaque values reserved from
+ * the connection and their responses are routed by the opaque they carry
+ * back, so a response that does not belong to any pending request is
+ * detected. Once the connection fails, all pending requests fail and the
+ * connection stays broken; the caller is expected to create new one.
+ */
+class async_connection_t {
+public:
+    /** Parses response of the request from received data. The reader throws
+     * incomplete_t if data does not contain whole response yet. It returns
+     * false if the response has not been understood and the connection can't
+     * be used anymore.
+     */
+    typedef std::function<bool (buffer_t &)> reader_t;
+
+    /** Called once the request is finished. The error is empty if reader has
+     * parsed the response successfuly.
+     */
+    typedef std::function<void (std::exception_ptr)> handler_t;
+
+    /** Returns opaque of the next response in received data. It throws
+     * incomplete_t if the data does not contain enough bytes yet.
+     */
+    typedef std::function<uint32_t (const buffer_t &)> router_t;
+
+    /** Identifies tagged request by range of opaque values.
+     */
+    class tag_t {
+    public:
+        uint32_t opaque = 0; //!< first opaque of the request
+        uint32_t count = 0;  //!< count of opaques owned by request
+        router_t router;     //!< extracts opaque from response
+    };
+
+    /** C'tor: the connection is established lazily by first request.
+     */
+    async_connection_t(const std::string &addr, opts_t opts);
+
+    /** D'tor: closes the socket; pending requests fail.
+     */
+    ~async_connection_t();
+
+    /** Queues request to server. The handler is called from reactor thread.
+     */
+    void send(std::string data, reader_t reader, handler_t handler);
+
+    /** Queues tagged request to server. Its response is found by opaque
+     * regardless of the order of responses.
+     */
+    void send(std::string data, reader_t reader, handler_t handler,
+              tag_t tag);
+
+    /** Reserves count of consecutive opaque values that are unique among
+     * the requests of this connection.
+     * @return first reserved value.
+     */
+    uint32_t reserve(uint32_t count);
+
+    /** Returns true if connection has failed and can't be used anymore.
+     */
+    bool is_broken() const;
+
+protected:
+    /** Pimple class.
+     */
+    class pimple_connection_t;
+
+    // shortcut
+    using pimple_connection_ptr_t = std::shared_ptr<pimple_connection_t>;
+
+    pimple_connection_ptr_t socket; //!< hides i/o implementation
+};
+
+} // namespace tcp
+} // namespace io
+} // namespace mc
+
+#endif /* MCACHE_IO_ASYNC_CONNECTION_H */
@@ -0,0 +1,86 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Connection-like view of received data.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_IO_BUFFER_H
+#define MCACHE_IO_BUFFER_H
+
+#include <string>
+
+namespace mc {
+namespace io {
+
+/** Thrown by buffer if it does not contain all requested data yet. It does
+ * not derive from error_t because it is not an error: the response parser is
+ * simply restarted when more data arrives.
+ */
+class incomplete_t {};
+
+/** Connection-like view of data that have been received from server. It
+ * provides the same read interface as connections so the command parser can
+ * parse responses of the async connections.
+ */
+class buffer_t {
+public:
+    /** C'tor.
+     */
+    explicit buffer_t(const std::string &data, std::size_t pos = 0)
+        : data(&data), pos(pos)
+    {}
+
+    /** Reads data till delimiter and returns it (delimiter is included).
+     */
+    std::string read(const std::string &delimiter) {
+        auto idx = data->find(delimiter, pos);
+        if (idx == std::string::npos) throw incomplete_t();
+        return read(idx + delimiter.size() - pos);
+    }
+
+    /** Reads bytes count data and returns it.
+     */
+    std::string read(std::size_t bytes) {
+        if (available() < bytes) throw incomplete_t();
+        std::string result = data->substr(pos, bytes);
+        pos += bytes;
+        return result;
+    }
+
+    /** Returns bytes count data without consuming them.
+     */
+    std::string peek(std::size_t bytes) const {
+        if (available() < bytes) throw incomplete_t();
+        return data->substr(pos, bytes);
+    }
+
+    /** Returns count of bytes that have not been read yet.
+     */
+    std::size_t available() const { return data->size() - pos;}
+
+    /** Returns position of first unread byte.
+     */
+    std::size_t position() const { return pos;}
+
+protected:
+    const std::string *data; //!< received data
+    std::size_t pos;         //!< first unread byte
+};
+
+} // namespace io
+} // namespace mc
+
+#endif /* MCACHE_IO_BUFFER_H */
@@ -22,6 +22,7 @@
 
 #include <string>
 #include <memory>
+#include <chrono>
 
 #include <mcache/error.h>
 #include <mcache/io/opts.h>
@@ -62,6 +63,91 @@ protected:
     pimple_connection_ptr_t socket; //!< hides i/o implementation
 };
 
+/** I/O object that holds one tcp socket to memcache server and provides the
+ * same interface as connection_t. Unlike the connection_t it has neither own
+ * event loop nor own timer: all sockets are driven by the shared reactor (see
+ * opts_t::reactor) and the calling thread just waits for the completion of the
+ * i/o operation till its deadline.
+ */
+class reactor_connection_t {
+public:
+    /** C'tor.
+     */
+    reactor_connection_t(const std::string &addr, opts_t opts);
+
+    /** Sends all data to server.
+     */
+    void write(const std::string &data);
+
+    /** Reads data till delimiter and returns it.
+     */
+    std::string read(const std::string &delimiter);
+
+    /** Reads bytes count data and returns it.
+     */
+    std::string read(std::size_t bytes);
+
+protected:
+    /** Pimple class.
+     */
+    class pimple_connection_t;
+
+    // shortcut
+    using pimple_connection_ptr_t = std::shared_ptr<pimple_connection_t>;
+
+    pimple_connection_ptr_t socket; //!< hides i/o implementation
+};
+
+/** I/O object that holds one tcp socket to memcache server and provides the
+ * same interface as connection_t. It uses plain non-blocking socket and poll()
+ * with the deadline computed from monotonic clock instead of asio event loop
+ * and deadline timer, so each op costs just the send()/recv() syscalls (and the
+ * poll() if the data are not ready yet).
+ */
+class poll_connection_t {
+public:
+    /** C'tor.
+     */
+    poll_connection_t(const std::string &addr, opts_t opts);
+
+    /** D'tor.
+     */
+    ~poll_connection_t();
+
+    // non copyable
+    poll_connection_t(const poll_connection_t &) = delete;
+    poll_connection_t &operator=(const poll_connection_t &) = delete;
+
+    /** Sends all data to server.
+     */
+    void write(const std::string &data);
+
+    /** Reads data till delimiter and returns it.
+     */
+    std::string read(const std::string &delimiter);
+
+    /** Reads bytes count data and returns it.
+     */
+    std::string read(std::size_t bytes);
+
+protected:
+    // shortcut
+    using deadline_t = std::chrono::steady_clock::time_point;
+
+    /** Waits till socket is ready for given events or deadline expires.
+     */
+    void wait(short events, deadline_t deadline, const char *op);
+
+    /** Receives available data to input buffer.
+     */
+    void fill(deadline_t deadline);
+
+    std::string addr;  //!< destination address
+    opts_t opts;       //!< connection options
+    int fd;            //!< socket descriptor
+    std::string input; //!< input buffer for incoming data
+};
+
 } // namespace tcp
 
 namespace udp {
@@ -23,6 +23,8 @@
 #include <stack>
 #include <memory>
 #include <mutex>
+#include <atomic>
+#include <algorithm>
 #include <inttypes.h>
 
 #if HAVE_LIBTBB
@@ -116,7 +118,7 @@ public:
 
     /** Returns count of connections in pool.
      */
-    std::size_t size() const { return connection;}
+    std::size_t size() const { return connection? 1: 0;}
 
     /** Destroy held connection.
      */
@@ -132,6 +134,87 @@ protected:
     connection_ptr_t connection; //!< current connection
 };
 
+/** Pool with small fixed count of connections that are shared by all callers
+ * at once (see opts_t::multiplexed_connections). It is suitable for
+ * connections that can carry many requests at once (async connections): the
+ * requests of many threads are queued, written in batches and the responses
+ * are demultiplexed back to their callers, so the count of sockets per server
+ * does not grow with count of threads. The callers are spread over
+ * connections in round robin fashion and the broken connection is replaced by
+ * new one on next pick.
+ */
+template <typename connection_t>
+class shared_connection_pool_t {
+public:
+    // defines pointer to connection type
+    using connection_ptr_t = std::shared_ptr<connection_t>;
+
+    /** C'tor.
+     */
+    explicit inline
+    shared_connection_pool_t(const std::string &addr, opts_t opts)
+        : addr(addr), opts(opts),
+          count(std::max<std::size_t>(opts.multiplexed_connections, 1)),
+          slots(new slot_t[count]), next(0)
+    {}
+
+    /** Returns one of shared connections; it stays in pool.
+     */
+    connection_ptr_t pick() {
+        slot_t &slot = slots[next.fetch_add(1, std::memory_order_relaxed)
+                             % count];
+        std::lock_guard<std::mutex> guard(slot.mutex);
+        if (!slot.connection || slot.connection->is_broken())
+            slot.connection = std::make_shared<connection_t>(addr, opts);
+        return slot.connection;
+    }
+
+    /** Does nothing but releases given ptr.
+     * XXX: Given ptr is invalid (empty) after the call.
+     */
+    void push_back(connection_ptr_t &tmp) { tmp.reset();}
+
+    /** Returns count of connections in pool.
+     */
+    std::size_t size() const {
+        std::size_t result = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            std::lock_guard<std::mutex> guard(slots[i].mutex);
+            if (slots[i].connection) ++result;
+        }
+        return result;
+    }
+
+    /** Destroy held connections.
+     */
+    void clear() {
+        for (std::size_t i = 0; i < count; ++i) {
+            connection_ptr_t tmp;
+            std::lock_guard<std::mutex> guard(slots[i].mutex);
+            tmp.swap(slots[i].connection);
+        }
+    }
+
+    /** Returns server address.
+     */
+    const std::string &server_name() const { return addr;}
+
+protected:
+    /** Holds one shared connection.
+     */
+    class slot_t {
+    public:
+        mutable std::mutex mutex;    //!< slot mutex
+        connection_ptr_t connection; //!< shared connection
+    };
+
+    std::string addr;                 //!< destination address
+    opts_t opts;                      //!< io options
+    std::size_t count;                //!< count of connections
+    std::unique_ptr<slot_t[]> slots;  //!< shared connections
+    std::atomic<std::size_t> next;    //!< slot for next pick
+};
+
 namespace bbt {
 
 #if HAVE_LIBTBB
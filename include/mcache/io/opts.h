@@ -20,11 +20,15 @@
 #ifndef MCACHE_IO_OPTS_H
 #define MCACHE_IO_OPTS_H
 
+#include <memory>
 #include <mcache/time-units.h>
 
 namespace mc {
 namespace io {
 
+// forward declaration
+class reactor_t;
+
 /** Connection options.
  */
 class opts_t {
@@ -87,7 +91,9 @@ public:
 
     /** C'tor.
      */
-    opts_t(): timeouts(), max_connections_in_pool(30) {}
+    opts_t()
+        : timeouts(), max_connections_in_pool(30), multiplexed_connections(2)
+    {}
 
     /** C'tor.
      */
@@ -99,7 +105,8 @@ public:
         : timeouts(milliseconds_t(connect),
                    milliseconds_t(read),
                    milliseconds_t(write)),
-          max_connections_in_pool(max_connections_in_pool)
+          max_connections_in_pool(max_connections_in_pool),
+          multiplexed_connections(2)
     {}
 
     /** C'tor.
@@ -109,11 +116,14 @@ public:
            milliseconds_t write,
            uint64_t max_connections_in_pool = 30)
         : timeouts(connect, read, write),
-          max_connections_in_pool(max_connections_in_pool)
+          max_connections_in_pool(max_connections_in_pool),
+          multiplexed_connections(2)
     {}
 
-    timeouts_t timeouts;              //!< connection timeouts
-    uint64_t max_connections_in_pool; //!< max count of connections in pool
+    timeouts_t timeouts;                //!< connection timeouts
+    uint64_t max_connections_in_pool;   //!< max count of connections in pool
+    uint64_t multiplexed_connections;   //!< count of shared async connections
+    std::shared_ptr<reactor_t> reactor; //!< event loop of async connections
 };
 
 } // namespace io
@@ -0,0 +1,81 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Event loop shared by async connections.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_IO_REACTOR_H
+#define MCACHE_IO_REACTOR_H
+
+#include <memory>
+#include <cstddef>
+
+namespace boost {
+namespace asio {
+
+// forward declaration (the asio stays hidden in library sources)
+class io_context;
+
+} // namespace asio
+} // namespace boost
+
+namespace mc {
+namespace io {
+
+/** Event loop that drives sockets of all async connections attached to it.
+ * The reactor either runs own threads or it is attached to the foreign event
+ * loop that is run by the caller.
+ */
+class reactor_t {
+public:
+    /** C'tor: starts given count of threads running the event loop.
+     */
+    explicit reactor_t(std::size_t threads = 1);
+
+    /** C'tor: attaches to foreign event loop; no threads are started.
+     */
+    explicit reactor_t(boost::asio::io_context &context);
+
+    /** D'tor: stops the threads (if any). It may be called from handler
+     * running in reactor thread; that thread is detached then.
+     */
+    ~reactor_t();
+
+    // non copyable
+    reactor_t(const reactor_t &) = delete;
+    reactor_t &operator=(const reactor_t &) = delete;
+
+    /** Returns event loop.
+     */
+    boost::asio::io_context &context();
+
+    /** Returns reactor used by connections without own one. It is created on
+     * first use and it runs one thread.
+     */
+    static std::shared_ptr<reactor_t> instance();
+
+protected:
+    /** Pimple class.
+     */
+    class pimple_reactor_t;
+
+    std::unique_ptr<pimple_reactor_t> pimple; //!< hides i/o implementation
+};
+
+} // namespace io
+} // namespace mc
+
+#endif /* MCACHE_IO_REACTOR_H */
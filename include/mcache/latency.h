@@ -0,0 +1,119 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Latency statistics of memcache servers.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_LATENCY_H
+#define MCACHE_LATENCY_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <inttypes.h>
+
+#include <mcache/time-units.h>
+
+namespace mc {
+
+/** Configuration of ejection of slow servers (see aux::find_outliers()).
+ */
+class outlier_ejection_config_t {
+public:
+    /** C'tor.
+     */
+    outlier_ejection_config_t()
+        : factor(0), interval(1s), ejection(30s), min_samples(20),
+          min_latency(1ms), max_ejected(0.25), alpha(0.1)
+    {}
+
+    double factor;              //!< multiple of median that ejects (0=off)
+    milliseconds_t interval;    //!< how often the latencies are compared
+    milliseconds_t ejection;    //!< how long the slow server is ejected
+    uint32_t min_samples;       //!< min # of samples to judge the server
+    microseconds_t min_latency; //!< the faster servers are never ejected
+    double max_ejected;         //!< max share of ejected servers
+    double alpha;               //!< weight of new sample in moving average
+};
+
+/** Latency statistics of server: exponentially weighted moving average and
+ * percentile sketch. The sketch is histogram with four logarithmic buckets
+ * per octave of microseconds (the percentiles are off by 10% at most) whose
+ * counts are halved by decay() so it follows recent latencies. It consists
+ * of atomics only so it can live in memory shared by processes.
+ */
+class latency_t {
+public:
+    /// count of buckets of percentile sketch
+    static constexpr std::size_t buckets = 128;
+
+    /** C'tor.
+     */
+    latency_t();
+
+    /** Adds latency of one request.
+     * @param latency the latency.
+     * @param alpha weight of sample in moving average.
+     */
+    void record(microseconds_t latency, double alpha);
+
+    /** Returns moving average of latencies.
+     */
+    microseconds_t average() const;
+
+    /** Returns latency that is not exceeded by given share of samples in
+     * sketch.
+     */
+    microseconds_t percentile(double share) const;
+
+    /** Returns count of samples in sketch.
+     */
+    uint64_t samples() const;
+
+    /** Halves counts in sketch.
+     */
+    void decay();
+
+    /** Forgets all samples.
+     */
+    void reset();
+
+protected:
+    std::atomic<double> ewma;              //!< moving average in us (<0=none)
+    std::atomic<uint32_t> counts[buckets]; //!< percentile sketch
+};
+
+namespace aux {
+
+/** Returns indices of servers whose latency is at least factor times the
+ * median latency of the servers (both the moving average and the sketch
+ * median have to exceed it). The servers with few samples are not judged,
+ * at least three judged servers are required and the count of ejected
+ * servers is limited by max_ejected share; the slowest are picked first.
+ * @param latencies latencies of servers (null for ejected servers).
+ * @param cfg ejection config.
+ * @param median the median latency.
+ * @return indices of slow servers.
+ */
+std::vector<std::size_t>
+find_outliers(const std::vector<const latency_t *> &latencies,
+              const outlier_ejection_config_t &cfg,
+              microseconds_t &median);
+
+} // namespace aux
+} // namespace mc
+
+#endif /* MCACHE_LATENCY_H */
@@ -22,6 +22,7 @@
 
 #include <mcache/init.h>
 #include <mcache/hash.h>
+#include <mcache/async.h>
 #include <mcache/client.h>
 #include <mcache/proto/txt.h>
 #include <mcache/proto/binary.h>
@@ -30,6 +31,8 @@
 #include <mcache/pool/consistent-hashing.h>
 #include <mcache/io/connections.h>
 #include <mcache/io/connection.h>
+#include <mcache/io/async-connection.h>
+#include <mcache/io/reactor.h>
 
 namespace mc {
 namespace thread {
@@ -49,8 +52,71 @@ typedef mc::server_proxies_t<shared_array_t, server_proxy_t> server_proxies_t;
 /// Defines default instantiation of the client template for thread enviroment.
 typedef mc::client_template_t<pool_t, server_proxies_t, api> client_t;
 
+namespace reactor {
+
+// configuration classes
+typedef mc::server_proxy_config_t server_proxy_config_t;
+typedef mc::consistent_hashing_pool_config_t pool_config_t;
+typedef mc::client_config_t client_config_t;
+
+// defines types for client template (sockets driven by shared reactor)
+using proto::bin::api;
+typedef mc::consistent_hashing_pool_t<murmur3_t> pool_t;
+typedef io::caching_connection_pool_t<io::tcp::reactor_connection_t>
+        connections_t;
+typedef mc::server_proxy_t<lock_t, connections_t> server_proxy_t;
+typedef mc::server_proxies_t<shared_array_t, server_proxy_t> server_proxies_t;
+
+/// Defines instantiation of the client template with shared reactor.
+typedef mc::client_template_t<pool_t, server_proxies_t, api> client_t;
+
+} // namespace reactor
+
+namespace pipelined {
+
+// configuration classes
+typedef mc::server_proxy_config_t server_proxy_config_t;
+typedef mc::consistent_hashing_pool_config_t pool_config_t;
+typedef mc::client_config_t client_config_t;
+
+// defines types for client template (all threads share few pipelined
+// connections per server; responses are matched by opaque)
+using proto::bin::api;
+typedef mc::consistent_hashing_pool_t<murmur3_t> pool_t;
+typedef io::shared_connection_pool_t<io::tcp::async_connection_t>
+        connections_t;
+typedef mc::server_proxy_t<lock_t, connections_t> server_proxy_t;
+typedef mc::server_proxies_t<shared_array_t, server_proxy_t> server_proxies_t;
+
+/// Defines instantiation of the client template with pipelined connections.
+typedef mc::client_template_t<pool_t, server_proxies_t, api> client_t;
+
+} // namespace pipelined
 } // namespace thread
 
+namespace async {
+
+// configuration classes
+typedef mc::server_proxy_config_t server_proxy_config_t;
+typedef mc::consistent_hashing_pool_config_t pool_config_t;
+typedef mc::client_config_t client_config_t;
+
+// defines types for client template
+using proto::bin::api;
+typedef mc::consistent_hashing_pool_t<murmur3_t> pool_t;
+typedef io::shared_connection_pool_t<io::tcp::async_connection_t>
+        connections_t;
+typedef mc::server_proxy_t<thread::lock_t, connections_t> server_proxy_t;
+typedef mc::server_proxies_t<
+            thread::shared_array_t,
+            server_proxy_t
+        > server_proxies_t;
+
+/// Defines default instantiation of the async client template.
+typedef mc::async_client_template_t<pool_t, server_proxies_t, api> client_t;
+
+} // namespace async
+
 namespace ipc {
 
 // configuration classes
@@ -21,9 +21,12 @@
 #define POOL_CONSISTENT_HASHING_H
 
 #include <map>
+#include <cmath>
 #include <vector>
 #include <string>
+#include <utility>
 #include <iterator>
+#include <type_traits>
 #include <stdint.h>
 #include <stdexcept>
 
@@ -38,12 +41,45 @@ public:
     /** C'tor.
      */
     consistent_hashing_pool_config_t()
-        : virtual_nodes(200)
+        : virtual_nodes(200), weights(), successors(0), snapshot()
     {}
 
-    uint32_t virtual_nodes; //!< count of virtual nodes in ring
+    /** Returns count of virtual nodes of server at given index. The count
+     * is virtual_nodes scaled by the weight of server (at least one node).
+     */
+    uint32_t nodes(std::size_t idx) const {
+        if (weights.empty()) return virtual_nodes;
+        double count = std::round(virtual_nodes * weights[idx]);
+        return count < 1? 1: static_cast<uint32_t>(count);
+    }
+
+    /** Throws std::invalid_argument if weights do not match the servers.
+     */
+    void check(std::size_t servers) const {
+        if (weights.empty()) return;
+        if (weights.size() != servers)
+            throw std::invalid_argument("count of weights != count of servers");
+        for (auto weight: weights)
+            if (!(weight > 0)) throw std::invalid_argument("weight <= 0");
+    }
+
+    uint32_t virtual_nodes;      //!< count of virtual nodes in ring per server
+    std::vector<double> weights; //!< server weights (empty means all 1)
+    uint32_t successors;         //!< distinct failover servers (0 = walk ring)
+    std::string snapshot;        //!< ring snapshot file of flat pools or empty
 };
 
+/** Returns true if both configs make the same ring. The snapshot path is not
+ * compared since it does not change the ring.
+ */
+inline bool operator==(const consistent_hashing_pool_config_t &lhs,
+                       const consistent_hashing_pool_config_t &rhs)
+{
+    return (lhs.virtual_nodes == rhs.virtual_nodes)
+        && (lhs.weights == rhs.weights)
+        && (lhs.successors == rhs.successors);
+}
+
 /** Non template base class for consistent hashing pool.
  */
 class consistent_hashing_pool_base_t {
@@ -53,7 +89,7 @@ public:
     /// namespace ring type
     typedef std::map<uint32_t, value_type> ring_t;
 
-    /** Dumps ring to string.
+    /** Dumps ring and share of ring of each server to string.
      */
     std::string dump(const ring_t &ring,
                      const std::vector<std::string> &states) const;
@@ -146,7 +182,9 @@ protected:
     bool stop;                    //!< sentinel
 };
 
-/** Ketama implementation of consistent hashing.
+/** Ketama implementation of consistent hashing. The servers may have weights
+ * (see consistent_hashing_pool_config_t) that scale their count of virtual
+ * nodes, so the bigger servers get bigger share of keys.
  */
 template <typename hash_function_t>
 class consistent_hashing_pool_t: public consistent_hashing_pool_base_t {
@@ -158,8 +196,13 @@ public:
     /// const iterator
     typedef consistent_hashing_pool_const_iterator const_iterator;
 
+    static_assert(std::is_same<decltype(std::declval<const hash_function_t &>()
+                                        (std::string())), uint32_t>::value,
+                  "use flat_consistent_hashing_pool_t for 64bit hashes");
+
     /** C'tor.
      * @param addresses list of server addresses.
+     * @param cfg pool config (virtual nodes and server weights).
      */
     consistent_hashing_pool_t(const std::vector<std::string> &addresses,
                               const consistent_hashing_pool_config_t &
@@ -168,6 +211,11 @@ public:
     {
         // at least one address must be supplied
         if (addresses.empty()) throw std::out_of_range(__PRETTY_FUNCTION__);
+        cfg.check(addresses.size());
+
+        // the map ring has no rows of successors (see flat pools)
+        if (cfg.successors)
+            throw std::invalid_argument("successors need flat or ketama pool");
 
         // create namespace ring
         for (std::vector<std::string>::const_iterator
@@ -181,7 +229,7 @@ public:
             uint32_t idx = static_cast<uint32_t>(std::distance(saddr, iaddr));
 
             // push server into namespace ring
-            for (uint32_t i = 0; i < cfg.virtual_nodes; ++i)
+            for (uint32_t i = 0; i < cfg.nodes(idx); ++i)
                 ring.insert(std::make_pair(hash = hashf(*iaddr, hash), idx));
         }
     }
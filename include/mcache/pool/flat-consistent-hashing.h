@@ -0,0 +1,553 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Consistent hashing pool backed by flat sorted arrays.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef POOL_FLAT_CONSISTENT_HASHING_H
+#define POOL_FLAT_CONSISTENT_HASHING_H
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+#include <typeinfo>
+#include <stdint.h>
+#include <stdexcept>
+
+#include <boost/interprocess/anonymous_shared_memory.hpp>
+
+#include <mcache/error.h>
+#include <mcache/pool/consistent-hashing.h>
+
+namespace mc {
+
+/** Non template base class for flat consistent hashing pool.
+ */
+class flat_consistent_hashing_pool_base_t {
+public:
+    /// namespace ring value type
+    typedef uint32_t value_type;
+    /// sorted hashes of ring nodes
+    typedef std::vector<uint32_t> hashes_t;
+    /// server indices of ring nodes (same order as hashes)
+    typedef std::vector<value_type> servers_t;
+
+    /** Dumps ring and share of ring of each server to string.
+     */
+    static std::string dump(const uint32_t *hashes,
+                            const value_type *servers,
+                            std::size_t size,
+                            const std::vector<std::string> &states);
+
+    /** Dumps ring in 64bit hash space and share of ring of each server to
+     * string.
+     */
+    static std::string dump(const uint64_t *hashes,
+                            const value_type *servers,
+                            std::size_t size,
+                            const std::vector<std::string> &states);
+
+    /** Returns rows of distinct successors of ring nodes. The row of node
+     * holds the first depth distinct servers met by walking the ring from
+     * the node (the depth is lowered to the count of distinct servers).
+     * @param servers server indices of ring nodes.
+     * @param depth requested count of servers in row.
+     * @param result the rows.
+     * @return count of servers in row.
+     */
+    static uint32_t successors(const servers_t &servers,
+                               uint32_t depth,
+                               servers_t &result);
+
+    /** Ring arrays mapped from snapshot file.
+     */
+    class snapshot_t {
+    public:
+        std::shared_ptr<const void> memory;  //!< mapped file (null = none)
+        const void *hashes = nullptr;        //!< sorted hashes of ring nodes
+        const value_type *servers = nullptr; //!< server indices of ring nodes
+        const value_type *rows = nullptr;    //!< successors of ring nodes
+        std::size_t size = 0;                //!< count of ring nodes
+        uint32_t depth = 0;                  //!< count of servers in row
+    };
+
+    /** Returns checksum of everything the ring is made of: the addresses, the
+     * pool config (except the snapshot path) and the identification of hash
+     * function.
+     */
+    static uint64_t checksum(const std::vector<std::string> &addresses,
+                             const consistent_hashing_pool_config_t &cfg,
+                             const std::string &hash_id);
+
+    /** Writes ring arrays to snapshot file. The file is written aside and
+     * renamed so the readers never see it incomplete. The failure is only
+     * logged since the snapshot is just a cache.
+     * @return true if snapshot has been written.
+     */
+    static bool save(const std::string &path, uint64_t checksum,
+                     uint32_t hash_size, const void *hashes,
+                     const value_type *servers, const value_type *rows,
+                     std::size_t size, uint32_t depth);
+
+    /** Maps snapshot file to memory. The snapshot with null memory is returned
+     * if the file is missing, damaged or made for another ring.
+     * @param servers count of servers; greater server indices reject the file.
+     */
+    static snapshot_t load(const std::string &path, uint64_t checksum,
+                           uint32_t hash_size, std::size_t servers);
+
+    /** Returns index of the first hash that is not less than given value. The
+     * search has no data dependent branches so it does not suffer from branch
+     * mispredictions and the CPU can prefetch both halves.
+     */
+    template <typename hash_t>
+    static std::size_t
+    lower_bound(const hash_t *hashes, std::size_t size, hash_t value) {
+        if (!size) return 0;
+        const hash_t *base = hashes;
+        for (; size > 1;) {
+            std::size_t half = size / 2;
+            base = (base[half] < value)? base + half: base;
+            size -= half;
+        }
+        return std::size_t(base - hashes) + (*base < value);
+    }
+};
+
+/** Parent type for const iterator of the flat_consistent_hashing_pool_t.
+ */
+typedef std::iterator<
+            std::forward_iterator_tag,
+            const flat_consistent_hashing_pool_base_t::value_type
+        > flat_consistent_hashing_pool_const_iterator_parent_t;
+
+/** Const iterator for flat namespace ring. It walks the ring in the same order
+ * as consistent_hashing_pool_const_iterator does.
+ */
+class flat_consistent_hashing_pool_const_iterator
+    : public flat_consistent_hashing_pool_const_iterator_parent_t
+{
+public:
+    // shortcuts and standard iterators stuff
+    typedef flat_consistent_hashing_pool_const_iterator_parent_t parent_t;
+    typedef parent_t::reference reference;
+    typedef parent_t::pointer pointer;
+    typedef parent_t::value_type value_type;
+
+    /** C'tor.
+     */
+    inline flat_consistent_hashing_pool_const_iterator(pointer inode,
+                                                       pointer snode,
+                                                       pointer enode)
+        : inode(inode == enode? snode: inode), snode(snode), enode(enode),
+          stop(false)
+    {}
+
+    /** C'tor.
+     */
+    inline flat_consistent_hashing_pool_const_iterator(pointer enode)
+        : inode(enode), snode(enode), enode(enode), stop(true)
+    {}
+
+    /** C'tor. Makes iterator that walks the range once (no wrapping).
+     */
+    inline flat_consistent_hashing_pool_const_iterator(pointer inode,
+                                                       pointer enode,
+                                                       bool)
+        : inode(inode), snode(inode), enode(enode), stop(true)
+    {}
+
+    /** Returns reference to current value.
+     */
+    inline reference operator*() const { return *inode;}
+
+    /** Returns pointer to current value.
+     */
+    inline pointer operator->() const { return inode;}
+
+    /** Moves to next item.
+     */
+    inline flat_consistent_hashing_pool_const_iterator &operator++() {
+        increment();
+        return *this;
+    }
+
+    /** Returns iterator to current item and moves to next one.
+     */
+    inline flat_consistent_hashing_pool_const_iterator operator++(int) {
+        flat_consistent_hashing_pool_const_iterator tmp(*this);
+        ++(*this);
+        return tmp;
+    }
+
+    /** Returns true if iterators points to same place.
+     */
+    bool
+    equal(const flat_consistent_hashing_pool_const_iterator &other) const {
+        if (inode == enode) return other.inode == other.enode;
+        return inode == other.inode;
+    }
+
+protected:
+    /** Increments current position in the ring.
+     */
+    inline void increment() {
+        // move to next entry in array or to begin of array
+        if (++inode == enode) {
+            if (!stop) {
+                inode = snode;
+                stop = true;
+            }
+        }
+    }
+
+    pointer inode; //!< current
+    pointer snode; //!< begin of array
+    pointer enode; //!< end of array
+    bool stop;     //!< sentinel
+};
+
+/** Immutable flat namespace ring: sorted hashes of ring nodes, server indices
+ * of ring nodes and optional rows of distinct successors. The arrays are
+ * owned by reference counted memory (heap or anonymous shared memory) so the
+ * copies of ring share them.
+ */
+template <typename hash_t>
+class flat_ring_t: public flat_consistent_hashing_pool_base_t {
+public:
+    /// namespace ring value type
+    using flat_consistent_hashing_pool_base_t::value_type;
+    /// const iterator
+    typedef flat_consistent_hashing_pool_const_iterator const_iterator;
+
+    /** C'tor. Takes the ownership of arrays.
+     * @param hashes sorted hashes of ring nodes.
+     * @param servers server indices of ring nodes.
+     * @param rows distinct successors of ring nodes (depth per node).
+     * @param depth count of servers in row (0 = walk ring).
+     */
+    flat_ring_t(std::vector<hash_t> &&hashes, servers_t &&servers,
+                servers_t &&rows, uint32_t depth)
+        : memory(), hashes(), servers(), rows(), size(servers.size()),
+          depth(depth)
+    {
+        auto arrays = std::make_shared<arrays_t>();
+        arrays->hashes = std::move(hashes);
+        arrays->servers = std::move(servers);
+        arrays->rows = std::move(rows);
+        this->hashes = arrays->hashes.data();
+        this->servers = arrays->servers.data();
+        this->rows = arrays->rows.data();
+        memory = std::move(arrays);
+    }
+
+    /** C'tor. Makes ring of arrays that live in given memory.
+     * @param memory owner of the memory.
+     * @param hashes sorted hashes of ring nodes.
+     * @param servers server indices of ring nodes.
+     * @param rows distinct successors of ring nodes (depth per node).
+     * @param size count of ring nodes.
+     * @param depth count of servers in row (0 = walk ring).
+     */
+    flat_ring_t(std::shared_ptr<const void> memory,
+                const hash_t *hashes, const value_type *servers,
+                const value_type *rows, std::size_t size, uint32_t depth)
+        : memory(std::move(memory)), hashes(hashes), servers(servers),
+          rows(rows), size(size), depth(depth)
+    {}
+
+    /** C'tor. Makes ring of arrays mapped from snapshot file.
+     */
+    explicit flat_ring_t(const snapshot_t &snapshot)
+        : memory(snapshot.memory),
+          hashes(static_cast<const hash_t *>(snapshot.hashes)),
+          servers(snapshot.servers), rows(snapshot.rows),
+          size(snapshot.size), depth(snapshot.depth)
+    {}
+
+    /** Returns ring mapped from snapshot file cfg.snapshot. If there is no
+     * usable snapshot the ring is built by given builder and written to the
+     * file for the next time. The ring is always built if the cfg.snapshot
+     * is empty.
+     * @param addresses list of server addresses.
+     * @param cfg pool config.
+     * @param hash_id returns identification of hash function.
+     * @param build the ring builder.
+     */
+    template <typename build_t>
+    static flat_ring_t make(const std::vector<std::string> &addresses,
+                            const consistent_hashing_pool_config_t &cfg,
+                            std::string (*hash_id)(),
+                            build_t build)
+    {
+        if (cfg.snapshot.empty()) return build();
+
+        // invalid pools have no snapshots
+        if (addresses.empty()) throw std::out_of_range(__PRETTY_FUNCTION__);
+        cfg.check(addresses.size());
+
+        uint64_t sum = checksum(addresses, cfg, hash_id());
+        snapshot_t snapshot = load(cfg.snapshot, sum, sizeof(hash_t),
+                                   addresses.size());
+        if (snapshot.memory) return flat_ring_t(snapshot);
+        flat_ring_t ring = build();
+        save(cfg.snapshot, sum, sizeof(hash_t), ring.hashes, ring.servers,
+             ring.rows, ring.size, ring.depth);
+        return ring;
+    }
+
+    /** Returns iterator that points to the first server for given hash.
+     */
+    const_iterator choose(hash_t hash) const {
+        std::size_t inode = lower_bound(hashes, size, hash);
+        if (depth) {
+            if (inode == size) inode = 0;
+            const value_type *row = rows + inode * depth;
+            return const_iterator(row, row + depth, true);
+        }
+        return const_iterator(servers + inode, servers, servers + size);
+    }
+
+    /* Returns iterator that points to the first entry in namespace ring.
+     */
+    const_iterator begin() const {
+        return const_iterator(servers, servers, servers + size);
+    }
+
+    /** Returns iterator one past last entry in namespace ring.
+     */
+    const_iterator end() const { return const_iterator(servers + size);}
+
+    /** Dumps ring to string.
+     */
+    std::string dump(const std::vector<std::string> &states) const {
+        return flat_consistent_hashing_pool_base_t::dump(hashes, servers,
+                                                         size, states);
+    }
+
+    /** Returns copy of ring that lives in anonymous shared memory. The memory
+     * is inherited by forked processes and none of them ever copies it.
+     */
+    flat_ring_t in_shared_memory() const {
+        namespace bip = boost::interprocess;
+        std::size_t hashes_size = size * sizeof(hash_t);
+        std::size_t servers_size = size * sizeof(value_type);
+        std::size_t rows_size = size * depth * sizeof(value_type);
+        auto region = std::make_shared<bip::mapped_region>(
+                bip::anonymous_shared_memory(
+                    std::max<std::size_t>(
+                        hashes_size + servers_size + rows_size, 1)));
+        char *base = static_cast<char *>(region->get_address());
+        std::copy(hashes, hashes + size, reinterpret_cast<hash_t *>(base));
+        std::copy(servers, servers + size,
+                  reinterpret_cast<value_type *>(base + hashes_size));
+        std::copy(rows, rows + size * depth,
+                  reinterpret_cast<value_type *>(base + hashes_size
+                                                 + servers_size));
+        return flat_ring_t(
+                region,
+                reinterpret_cast<const hash_t *>(base),
+                reinterpret_cast<const value_type *>(base + hashes_size),
+                reinterpret_cast<const value_type *>(base + hashes_size
+                                                     + servers_size),
+                size, depth);
+    }
+
+protected:
+    /** Arrays allocated on heap.
+     */
+    class arrays_t {
+    public:
+        std::vector<hash_t> hashes; //!< sorted hashes of ring nodes
+        servers_t servers;          //!< server indices of ring nodes
+        servers_t rows;             //!< distinct successors of ring nodes
+    };
+
+    std::shared_ptr<const void> memory; //!< owner of arrays
+    const hash_t *hashes;               //!< sorted hashes of ring nodes
+    const value_type *servers;          //!< server indices of ring nodes
+    const value_type *rows;             //!< distinct successors of ring nodes
+    std::size_t size;                   //!< count of ring nodes
+    uint32_t depth;                     //!< count of servers in row
+};
+
+/** Ketama implementation of consistent hashing that is drop-in replacement of
+ * consistent_hashing_pool_t (it makes the same ring). The ring is stored in
+ * two contiguous arrays: sorted hashes, that are searched by choose(), and
+ * server indices, that are walked by iterator. So the lookup touches a few
+ * cache lines instead of chasing the pointers of tree nodes.
+ *
+ * If consistent_hashing_pool_config_t::successors is set then the first
+ * successors distinct servers following each ring node are precomputed and
+ * the iterator returned by choose() walks them only; the failover never
+ * visits the same server twice.
+ *
+ * The width of hash space is given by the hash functor. The 64bit functors
+ * (e.g. city64_t or xxh3_64_t) make the ring of large clusters free of node
+ * collisions and more even than 32bit ones.
+ *
+ * If consistent_hashing_pool_config_t::snapshot names a file then the ring is
+ * mapped from it instead of being built (see flat_ring_t::make()); cold start
+ * of short living processes then costs a few page faults only.
+ */
+template <typename hash_function_t>
+class flat_consistent_hashing_pool_t
+    : public flat_consistent_hashing_pool_base_t
+{
+public:
+    /// namespace ring value type
+    using flat_consistent_hashing_pool_base_t::value_type;
+    /// const iterator
+    typedef flat_consistent_hashing_pool_const_iterator const_iterator;
+    /// type of hash of ring nodes (uint32_t or uint64_t)
+    typedef decltype(std::declval<const hash_function_t &>()(std::string()))
+            hash_type;
+
+    static_assert(std::is_same<hash_type, uint32_t>::value
+                  || std::is_same<hash_type, uint64_t>::value,
+                  "hash function has to return uint32_t or uint64_t");
+
+    /** C'tor.
+     * @param addresses list of server addresses.
+     * @param cfg pool config (virtual nodes, server weights, snapshot...).
+     */
+    flat_consistent_hashing_pool_t(const std::vector<std::string> &addresses,
+                                   const consistent_hashing_pool_config_t &
+                                   cfg = consistent_hashing_pool_config_t())
+        : ring(flat_ring_t<hash_type>::make(
+                    addresses, cfg, &hash_id,
+                    [&] { return build(addresses, cfg);})),
+          hashf()
+    {}
+
+    /* Returns iterator that points to the first index of usable server.
+     */
+    const_iterator choose(const std::string &key) const {
+        return ring.choose(hashf(key));
+    }
+
+    /* Returns iterator that points to the first entry in namespace ring.
+     */
+    const_iterator begin() const { return ring.begin();}
+
+    /** Returns iterator one past last entry in namespace ring.
+     */
+    const_iterator end() const { return ring.end();}
+
+    /** Dumps ring to string.
+     */
+    std::string dump(const std::vector<std::string> &
+                     states = std::vector<std::string>()) const
+    {
+        return ring.dump(states);
+    }
+
+    /** Returns copy of pool whose ring lives in anonymous shared memory.
+     */
+    flat_consistent_hashing_pool_t in_shared_memory() const {
+        flat_consistent_hashing_pool_t result(*this);
+        result.ring = ring.in_shared_memory();
+        return result;
+    }
+
+protected:
+    /** Returns identification of hash function: its type and a few hashes
+     * (so the snapshot of changed implementation is not used).
+     */
+    static std::string hash_id() {
+        hash_function_t hashf;
+        return std::string(typeid(hash_function_t).name())
+            + ":" + std::to_string(hashf("mcache"))
+            + ":" + std::to_string(hashf("mcache", 1));
+    }
+
+    /** Builds namespace ring.
+     */
+    static flat_ring_t<hash_type>
+    build(const std::vector<std::string> &addresses,
+          const consistent_hashing_pool_config_t &cfg)
+    {
+        // at least one address must be supplied
+        if (addresses.empty()) throw std::out_of_range(__PRETTY_FUNCTION__);
+        cfg.check(addresses.size());
+
+        // create namespace ring nodes in the same order as map based pool
+        hash_function_t hashf;
+        std::vector<std::pair<hash_type, value_type>> nodes;
+        for (std::size_t idx = 0; idx < addresses.size(); ++idx) {
+            hash_type hash = 0;
+            for (uint32_t i = 0; i < cfg.nodes(idx); ++i) {
+                hash = hashf(addresses[idx], hash);
+                nodes.emplace_back(hash, static_cast<value_type>(idx));
+            }
+        }
+
+        // the first inserted node wins hash collision (like map::insert)
+        std::stable_sort(nodes.begin(), nodes.end(),
+                         [] (const auto &lhs, const auto &rhs) {
+                             return lhs.first < rhs.first;
+                         });
+        nodes.erase(std::unique(nodes.begin(), nodes.end(),
+                                [] (const auto &lhs, const auto &rhs) {
+                                    return lhs.first == rhs.first;
+                                }),
+                    nodes.end());
+
+        // split nodes to hashes and server indices
+        std::vector<hash_type> hashes;
+        servers_t servers;
+        hashes.reserve(nodes.size());
+        servers.reserve(nodes.size());
+        for (auto &node: nodes) {
+            hashes.push_back(node.first);
+            servers.push_back(node.second);
+        }
+
+        // precompute distinct failover servers
+        servers_t rows;
+        uint32_t depth = 0;
+        if (cfg.successors) depth = successors(servers, cfg.successors, rows);
+        return flat_ring_t<hash_type>(std::move(hashes), std::move(servers),
+                                      std::move(rows), depth);
+    }
+
+    flat_ring_t<hash_type> ring; //!< namespace ring
+    hash_function_t hashf;       //!< hash functor
+};
+
+/** Comparison operator==.
+ */
+inline bool operator==(const flat_consistent_hashing_pool_const_iterator &lhs,
+                       const flat_consistent_hashing_pool_const_iterator &rhs)
+{
+    return lhs.equal(rhs);
+}
+
+/** Comparison operator!=.
+ */
+inline bool operator!=(const flat_consistent_hashing_pool_const_iterator &lhs,
+                       const flat_consistent_hashing_pool_const_iterator &rhs)
+{
+    return !lhs.equal(rhs);
+}
+
+} // namespace mc
+
+#endif /* POOL_FLAT_CONSISTENT_HASHING_H */
@@ -0,0 +1,209 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Pools shared by clients with identical config.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_POOL_INTERNED_H
+#define MCACHE_POOL_INTERNED_H
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include <mcache/pool/consistent-hashing.h>
+
+namespace mc {
+
+/** Registry of pools that are alive. The pools are looked up by list of
+ * addresses and pool config; the pool type (including hash function) and the
+ * placement of pool are given by template arguments. The registry holds weak
+ * references only, so the pool is destroyed with its last user.
+ */
+template <typename pool_t, typename pool_config_t, bool shared_memory>
+class pool_registry_t {
+public:
+    /// shared immutable pool
+    typedef std::shared_ptr<const pool_t> pool_ptr_t;
+
+    /** Returns pool for given addresses and config. The pool is built if
+     * there is no alive pool with the same addresses and config.
+     */
+    static pool_ptr_t get(const std::vector<std::string> &addresses,
+                          const pool_config_t &cfg)
+    {
+        auto &instance = registry();
+        std::lock_guard<std::mutex> guard(instance.mutex);
+
+        // drop the entries of destroyed pools and look for alive one
+        auto &entries = instance.entries;
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [] (const entry_t &entry) {
+                                         return entry.pool.expired();
+                                     }),
+                      entries.end());
+        for (auto &entry: entries) {
+            if ((entry.addresses == addresses) && (entry.cfg == cfg)) {
+                if (auto pool = entry.pool.lock()) return pool;
+            }
+        }
+
+        // build new one
+        pool_ptr_t pool = build(addresses, cfg);
+        entries.push_back(entry_t{addresses, cfg, pool});
+        return pool;
+    }
+
+    /** Returns count of alive pools in registry.
+     */
+    static std::size_t size() {
+        auto &instance = registry();
+        std::lock_guard<std::mutex> guard(instance.mutex);
+        return std::count_if(instance.entries.begin(), instance.entries.end(),
+                             [] (const entry_t &entry) {
+                                 return !entry.pool.expired();
+                             });
+    }
+
+private:
+    /** Builds pool on heap or in anonymous shared memory.
+     */
+    static pool_ptr_t build(const std::vector<std::string> &addresses,
+                            const pool_config_t &cfg)
+    {
+        if constexpr (shared_memory) {
+            return std::make_shared<const pool_t>(
+                    pool_t(addresses, cfg).in_shared_memory());
+        } else {
+            return std::make_shared<const pool_t>(addresses, cfg);
+        }
+    }
+
+    /** Registry entry.
+     */
+    class entry_t {
+    public:
+        std::vector<std::string> addresses; //!< server addresses
+        pool_config_t cfg;                  //!< pool config
+        std::weak_ptr<const pool_t> pool;   //!< the pool
+    };
+
+    /** Registry data.
+     */
+    class registry_t {
+    public:
+        std::mutex mutex;             //!< guards entries
+        std::vector<entry_t> entries; //!< pools built so far
+    };
+
+    /** Returns registry instance.
+     */
+    static registry_t &registry() {
+        static registry_t instance;
+        return instance;
+    }
+};
+
+/** Pool adaptor that shares the pool with all other adaptors (e.g. the pools
+ * of other clients) made for the same addresses and config. The underlying
+ * pool is built once and it is immutable.
+ */
+template <
+    typename pool_type,
+    typename pool_config_type = consistent_hashing_pool_config_t,
+    bool shared_memory = false
+> class interned_pool_template_t {
+public:
+    // publish template params
+    typedef pool_type pool_t;
+    typedef pool_config_type pool_config_t;
+    /// pool value type
+    typedef typename pool_t::value_type value_type;
+    /// const iterator
+    typedef typename pool_t::const_iterator const_iterator;
+    /// registry of pools
+    typedef pool_registry_t<pool_t, pool_config_t, shared_memory> registry_t;
+
+    /** C'tor.
+     * @param addresses list of server addresses.
+     * @param cfg pool config.
+     */
+    interned_pool_template_t(const std::vector<std::string> &addresses,
+                             const pool_config_t &cfg = pool_config_t())
+        : pool(registry_t::get(addresses, cfg))
+    {}
+
+    /* Returns iterator that points to the first index of usable server.
+     */
+    const_iterator choose(const std::string &key) const {
+        return pool->choose(key);
+    }
+
+    /* Returns iterator that points to the first entry of pool.
+     */
+    const_iterator begin() const { return pool->begin();}
+
+    /** Returns iterator one past last entry of pool.
+     */
+    const_iterator end() const { return pool->end();}
+
+    /** Dumps pool to string.
+     */
+    std::string dump(const std::vector<std::string> &
+                     states = std::vector<std::string>()) const
+    {
+        return pool->dump(states);
+    }
+
+    /** Returns the shared pool.
+     */
+    const pool_t &get() const { return *pool;}
+
+protected:
+    std::shared_ptr<const pool_t> pool; //!< shared pool
+};
+
+namespace thread {
+
+/** Pool shared by clients within process.
+ */
+template <
+    typename pool_t,
+    typename pool_config_t = consistent_hashing_pool_config_t
+> using interned_pool_t = interned_pool_template_t<pool_t, pool_config_t>;
+
+} // namespace thread
+
+namespace ipc {
+
+/** Pool shared by clients within process whose ring lives in anonymous shared
+ * memory. If the pool is made before fork (and kept alive by parent) then the
+ * child processes find it in registry and share its memory with parent. The
+ * pool_t has to support in_shared_memory() (e.g. flat_consistent_hashing_pool_t
+ * or ketama_pool_t).
+ */
+template <
+    typename pool_t,
+    typename pool_config_t = consistent_hashing_pool_config_t
+> using interned_pool_t
+    = interned_pool_template_t<pool_t, pool_config_t, true>;
+
+} // namespace ipc
+} // namespace mc
+
+#endif /* MCACHE_POOL_INTERNED_H */
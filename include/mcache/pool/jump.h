@@ -0,0 +1,212 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Jump consistent hashing pool.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_POOL_JUMP_H
+#define MCACHE_POOL_JUMP_H
+
+#include <vector>
+#include <string>
+#include <iterator>
+#include <numeric>
+#include <stdint.h>
+#include <stdexcept>
+
+#include <mcache/hash/mix.h>
+
+namespace mc {
+
+/** Non template base class for jump pool.
+ */
+class jump_pool_base_t {
+public:
+    /// value type
+    typedef uint32_t value_type;
+
+    /** Lamping-Veach jump consistent hash: maps key to one of buckets. If
+     * bucket is appended only 1/(buckets + 1) keys move and all of them move
+     * to the new bucket.
+     */
+    static value_type jump(uint64_t key, value_type buckets) {
+        int64_t bucket = -1;
+        int64_t next = 0;
+        while (next < int64_t(buckets)) {
+            bucket = next;
+            key = key * 2862933555777941757ULL + 1;
+            next = int64_t(double(bucket + 1)
+                           * (double(1LL << 31) / double((key >> 33) + 1)));
+        }
+        return static_cast<value_type>(bucket);
+    }
+
+    /** Returns stride of failover walk for given key. The stride is coprime
+     * with count of servers so the walk visits each server exactly once, and
+     * it differs for keys so the keys of failed server are spread over all
+     * other servers.
+     */
+    static value_type stride(uint64_t key, value_type count) {
+        if (count < 3) return 1;
+        value_type result = 1 + static_cast<value_type>(key % (count - 1));
+        while (std::gcd(result, count) != 1)
+            result = result % (count - 1) + 1;
+        return result;
+    }
+};
+
+/** Parent type for const iterator of the jump_pool_t.
+ */
+typedef std::iterator<
+            std::forward_iterator_tag,
+            const jump_pool_base_t::value_type
+        > jump_pool_const_iterator_parent_t;
+
+/** Const iterator that starts at the server chosen by jump hash and then
+ * visits all other servers in deterministic (per key) order.
+ */
+class jump_pool_const_iterator: public jump_pool_const_iterator_parent_t {
+public:
+    // shortcuts and standard iterators stuff
+    typedef jump_pool_const_iterator_parent_t parent_t;
+    typedef parent_t::reference reference;
+    typedef parent_t::pointer pointer;
+    typedef parent_t::value_type value_type;
+    typedef jump_pool_base_t::value_type index_t;
+
+    /** C'tor.
+     */
+    inline jump_pool_const_iterator(index_t value,
+                                    index_t stride,
+                                    index_t count)
+        : value(value), stride(stride), count(count), step()
+    {}
+
+    /** C'tor.
+     */
+    explicit inline jump_pool_const_iterator(index_t count)
+        : value(), stride(), count(count), step(count)
+    {}
+
+    /** Returns reference to current value.
+     */
+    inline reference operator*() const { return value;}
+
+    /** Returns pointer to current value.
+     */
+    inline pointer operator->() const { return &value;}
+
+    /** Moves to next item.
+     */
+    inline jump_pool_const_iterator &operator++() {
+        increment();
+        return *this;
+    }
+
+    /** Returns iterator to current item and moves to next one.
+     */
+    inline jump_pool_const_iterator operator++(int) {
+        jump_pool_const_iterator tmp(*this);
+        ++(*this);
+        return tmp;
+    }
+
+    /** Returns true if iterators points to same place.
+     */
+    inline bool equal(const jump_pool_const_iterator &other) const {
+        if (step == count) return other.step == other.count;
+        return (step == other.step) && (value == other.value);
+    }
+
+protected:
+    /** Moves to next server of the failover walk.
+     */
+    inline void increment() {
+        if (step == count) return;
+        value = static_cast<index_t>((uint64_t(value) + stride) % count);
+        ++step;
+    }
+
+    index_t value;  //!< current server
+    index_t stride; //!< distance of next server
+    index_t count;  //!< count of servers
+    index_t step;   //!< count of visited servers
+};
+
+/** Pool that uses jump consistent hashing. It needs no memory per server and
+ * the lookup costs a few nanoseconds. When servers are appended to the end of
+ * the addresses list, the fewest possible keys move. Removing a server from
+ * the middle of the list moves many keys, so the dead servers should be left
+ * in the list (the iterator fails over to the other servers).
+ */
+template <typename hash_function_t>
+class jump_pool_t: public jump_pool_base_t {
+public:
+    /// value type
+    using jump_pool_base_t::value_type;
+    /// const iterator type
+    typedef jump_pool_const_iterator const_iterator;
+
+    /** C'tor.
+     */
+    jump_pool_t(const std::vector<std::string> &addresses)
+        : count(static_cast<value_type>(addresses.size())), hashf()
+    {
+        // at least one address must be supplied
+        if (addresses.empty()) throw std::out_of_range(__PRETTY_FUNCTION__);
+    }
+
+    /* Returns iterator that points to the first index of usable server.
+     */
+    const_iterator choose(const std::string &key) const {
+        uint64_t hash = mix64(hashf(key));
+        return const_iterator(jump(hash, count),
+                              stride(hash >> 32, count),
+                              count);
+    }
+
+    /* Returns iterator that points to the first entry.
+     */
+    const_iterator begin() const { return const_iterator(0, 1, count);}
+
+    /** Returns iterator one past last entry.
+     */
+    const_iterator end() const { return const_iterator(count);}
+
+protected:
+    value_type count;      //!< count of available servers
+    hash_function_t hashf; //!< hash functor
+};
+
+/** Comparison operator==.
+ */
+inline bool operator==(const jump_pool_const_iterator &lhs,
+                       const jump_pool_const_iterator &rhs)
+{
+    return lhs.equal(rhs);
+}
+
+/** Comparison operator!=.
+ */
+inline bool operator!=(const jump_pool_const_iterator &lhs,
+                       const jump_pool_const_iterator &rhs)
+{
+    return !lhs.equal(rhs);
+}
+
+} // namespace mc
+
+#endif /* MCACHE_POOL_JUMP_H */
@@ -0,0 +1,108 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Consistent hashing pool compatible with libketama.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_POOL_KETAMA_H
+#define MCACHE_POOL_KETAMA_H
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+#include <mcache/hash/md5.h>
+#include <mcache/pool/consistent-hashing.h>
+#include <mcache/pool/flat-consistent-hashing.h>
+
+namespace mc {
+
+/** Consistent hashing pool that places keys the same way as libketama (and
+ * the memcache clients compatible with it). Each server gets 40 MD5 digests
+ * of "address-N" strings (N = 0..39), each digest gives four ring points,
+ * and the key hash is the first point of MD5 digest of the key. The server
+ * weights from consistent_hashing_pool_config_t scale the count of digests
+ * like libketama does with server memory sizes; the virtual_nodes are
+ * ignored since their count is given by the algorithm. The ring is stored in
+ * flat arrays as in flat_consistent_hashing_pool_t (including the optional
+ * precomputed successors).
+ */
+class ketama_pool_t: public flat_consistent_hashing_pool_base_t {
+public:
+    /// namespace ring value type
+    using flat_consistent_hashing_pool_base_t::value_type;
+    /// const iterator
+    typedef flat_consistent_hashing_pool_const_iterator const_iterator;
+
+    /** C'tor.
+     * @param addresses list of server addresses (host:port).
+     * @param cfg pool config (server weights and snapshot file).
+     */
+    ketama_pool_t(const std::vector<std::string> &addresses,
+                  const consistent_hashing_pool_config_t &
+                  cfg = consistent_hashing_pool_config_t())
+        : ring(flat_ring_t<uint32_t>::make(
+                    addresses, cfg, &hash_id,
+                    [&] { return build(addresses, cfg);}))
+    {}
+
+    /* Returns iterator that points to the first index of usable server.
+     */
+    const_iterator choose(const std::string &key) const {
+        return ring.choose(ketama(key.data(), key.size()));
+    }
+
+    /* Returns iterator that points to the first entry in namespace ring.
+     */
+    const_iterator begin() const { return ring.begin();}
+
+    /** Returns iterator one past last entry in namespace ring.
+     */
+    const_iterator end() const { return ring.end();}
+
+    /** Dumps ring to string.
+     */
+    std::string dump(const std::vector<std::string> &
+                     states = std::vector<std::string>()) const
+    {
+        return ring.dump(states);
+    }
+
+    /** Returns copy of pool whose ring lives in anonymous shared memory.
+     */
+    ketama_pool_t in_shared_memory() const {
+        ketama_pool_t result(*this);
+        result.ring = ring.in_shared_memory();
+        return result;
+    }
+
+protected:
+    /** Returns identification of hash function.
+     */
+    static std::string hash_id() { return "ketama";}
+
+    /** Builds namespace ring.
+     */
+    static flat_ring_t<uint32_t>
+    build(const std::vector<std::string> &addresses,
+          const consistent_hashing_pool_config_t &cfg);
+
+    flat_ring_t<uint32_t> ring; //!< namespace ring
+};
+
+} // namespace mc
+
+#endif /* MCACHE_POOL_KETAMA_H */
@@ -0,0 +1,238 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Maglev hashing pool.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_POOL_MAGLEV_H
+#define MCACHE_POOL_MAGLEV_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdint.h>
+#include <stdexcept>
+
+#include <mcache/hash/mix.h>
+
+namespace mc {
+
+/** Configuration for maglev pool.
+ */
+class maglev_pool_config_t {
+public:
+    /** C'tor.
+     */
+    maglev_pool_config_t()
+        : table_size(65537), backups(3)
+    {}
+
+    uint32_t table_size; //!< size of lookup table (prime >= # of servers)
+    uint32_t backups;    //!< count of precomputed failover servers
+};
+
+/** Non template base class for maglev pool.
+ */
+class maglev_pool_base_t {
+public:
+    /// lookup table value type
+    typedef uint32_t value_type;
+    /// lookup table (and table of failover servers)
+    typedef std::vector<value_type> table_t;
+    /// preference permutation of server: offset and skip
+    typedef std::pair<uint32_t, uint32_t> permutation_t;
+
+    /** Returns true if value is prime.
+     */
+    static bool is_prime(uint32_t value);
+
+    /** Fills lookup table of given size. Servers take turns and each one
+     * takes the next free slot of its preference permutation, so each server
+     * gets almost the same count of slots.
+     */
+    static table_t populate(const std::vector<permutation_t> &permutations,
+                            uint32_t size);
+
+    /** Returns rows of failover servers; row of slot holds the first depth
+     * distinct servers found by walking the lookup table from that slot.
+     */
+    static table_t failovers(const table_t &table, uint32_t depth);
+
+    /** Dumps count of slots per server to string.
+     */
+    std::string dump(const table_t &table,
+                     const std::vector<std::string> &states) const;
+};
+
+/** Parent type for const iterator of the maglev_pool_t.
+ */
+typedef std::iterator<
+            std::forward_iterator_tag,
+            const maglev_pool_base_t::value_type
+        > maglev_pool_const_iterator_parent_t;
+
+/** Const iterator that walks a contiguous row of servers.
+ */
+class maglev_pool_const_iterator: public maglev_pool_const_iterator_parent_t {
+public:
+    // shortcuts and standard iterators stuff
+    typedef maglev_pool_const_iterator_parent_t parent_t;
+    typedef parent_t::reference reference;
+    typedef parent_t::pointer pointer;
+    typedef parent_t::value_type value_type;
+
+    /** C'tor.
+     */
+    inline maglev_pool_const_iterator(pointer inode, pointer enode)
+        : inode(inode), enode(enode)
+    {}
+
+    /** C'tor.
+     */
+    inline maglev_pool_const_iterator(): inode(), enode() {}
+
+    /** Returns reference to current value.
+     */
+    inline reference operator*() const { return *inode;}
+
+    /** Returns pointer to current value.
+     */
+    inline pointer operator->() const { return inode;}
+
+    /** Moves to next item.
+     */
+    inline maglev_pool_const_iterator &operator++() {
+        if (inode != enode) ++inode;
+        return *this;
+    }
+
+    /** Returns iterator to current item and moves to next one.
+     */
+    inline maglev_pool_const_iterator operator++(int) {
+        maglev_pool_const_iterator tmp(*this);
+        ++(*this);
+        return tmp;
+    }
+
+    /** Returns true if iterators points to same place.
+     */
+    inline bool equal(const maglev_pool_const_iterator &other) const {
+        if (inode == enode) return other.inode == other.enode;
+        return inode == other.inode;
+    }
+
+protected:
+    pointer inode; //!< current
+    pointer enode; //!< end of row
+};
+
+/** Pool that uses Maglev hashing. The servers are spread over fixed size
+ * lookup table and choose() is a single index into the table after hashing
+ * the key. Each slot has also precomputed row of failover servers, so the
+ * failover costs no lookup at all. Removing a server moves its slots and a
+ * few other ones. The table costs (backups + 2) * table_size * 4 bytes.
+ */
+template <typename hash_function_t>
+class maglev_pool_t: public maglev_pool_base_t {
+public:
+    /// lookup table value type
+    using maglev_pool_base_t::value_type;
+    /// const iterator type
+    typedef maglev_pool_const_iterator const_iterator;
+
+    /** C'tor.
+     * @param addresses list of server addresses.
+     * @param cfg pool config (table size and count of failover servers).
+     */
+    maglev_pool_t(const std::vector<std::string> &addresses,
+                  const maglev_pool_config_t &cfg = maglev_pool_config_t())
+        : table(), rows(), depth(), hashf()
+    {
+        // at least one address must be supplied
+        if (addresses.empty()) throw std::out_of_range(__PRETTY_FUNCTION__);
+        if ((cfg.table_size < addresses.size()) || !is_prime(cfg.table_size))
+            throw std::invalid_argument("table size is not prime >= servers");
+
+        // the preference permutation of server is derived from its address
+        std::vector<permutation_t> permutations;
+        permutations.reserve(addresses.size());
+        for (auto &address: addresses) {
+            uint64_t hash = mix64(hashf(address));
+            uint32_t offset = uint32_t(hash >> 32) % cfg.table_size;
+            uint32_t skip = uint32_t(hash) % (cfg.table_size - 1) + 1;
+            permutations.emplace_back(offset, skip);
+        }
+        table = populate(permutations, cfg.table_size);
+
+        // precompute failover servers
+        depth = uint32_t(std::min<std::size_t>(addresses.size(),
+                                               cfg.backups + 1));
+        rows = failovers(table, depth);
+    }
+
+    /* Returns iterator that points to the first index of usable server.
+     */
+    const_iterator choose(const std::string &key) const {
+        const value_type *row = rows.data() + hashf(key) % table.size() * depth;
+        return const_iterator(row, row + depth);
+    }
+
+    /* Returns iterator that points to the first slot of lookup table.
+     */
+    const_iterator begin() const {
+        return const_iterator(table.data(), table.data() + table.size());
+    }
+
+    /** Returns iterator one past last slot of lookup table.
+     */
+    const_iterator end() const { return const_iterator();}
+
+    /** Dumps count of slots per server to string.
+     */
+    std::string dump(const std::vector<std::string> &
+                     states = std::vector<std::string>()) const
+    {
+        return maglev_pool_base_t::dump(table, states);
+    }
+
+protected:
+    table_t table;         //!< lookup table
+    table_t rows;          //!< failover servers of each slot
+    uint32_t depth;        //!< count of servers in row
+    hash_function_t hashf; //!< hash functor
+};
+
+/** Comparison operator==.
+ */
+inline bool operator==(const maglev_pool_const_iterator &lhs,
+                       const maglev_pool_const_iterator &rhs)
+{
+    return lhs.equal(rhs);
+}
+
+/** Comparison operator!=.
+ */
+inline bool operator!=(const maglev_pool_const_iterator &lhs,
+                       const maglev_pool_const_iterator &rhs)
+{
+    return !lhs.equal(rhs);
+}
+
+} // namespace mc
+
+#endif /* MCACHE_POOL_MAGLEV_H */
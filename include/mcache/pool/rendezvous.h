@@ -0,0 +1,334 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Rendezvous (highest random weight) hashing pool.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_POOL_RENDEZVOUS_H
+#define MCACHE_POOL_RENDEZVOUS_H
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <string>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdint.h>
+#include <stdexcept>
+
+#include <mcache/hash/mix.h>
+
+namespace mc {
+
+/** Configuration for rendezvous pool.
+ */
+class rendezvous_pool_config_t {
+public:
+    /** C'tor.
+     */
+    rendezvous_pool_config_t(): weights() {}
+
+    /** C'tor.
+     */
+    explicit rendezvous_pool_config_t(const std::vector<double> &weights)
+        : weights(weights)
+    {}
+
+    std::vector<double> weights; //!< server weights (empty means all equal)
+};
+
+/** Non template base class for rendezvous pool.
+ */
+class rendezvous_pool_base_t {
+public:
+    /// value type
+    typedef uint32_t value_type;
+
+    /** Servers ordered by their score for one key.
+     */
+    class ranking_t {
+    public:
+        /// server score and index
+        typedef std::pair<double, value_type> node_t;
+
+        /** Moves the server with the highest score among the servers behind
+         * given position to the next position. The failover rarely walks more
+         * than a few servers so the full sort would be waste of time.
+         */
+        void select(std::size_t pos) {
+            if (pos + 1 >= nodes.size()) return;
+            auto best = std::max_element(nodes.begin() + pos + 1, nodes.end(),
+                                         [] (const node_t &lhs,
+                                             const node_t &rhs) {
+                                             if (lhs.first != rhs.first)
+                                                 return lhs.first < rhs.first;
+                                             return lhs.second > rhs.second;
+                                         });
+            std::iter_swap(nodes.begin() + pos + 1, best);
+        }
+
+        std::vector<node_t> nodes; //!< servers and their scores
+    };
+
+    /** Returns score of server for given key. The key prefers the server with
+     * the highest score. The weighted score is -weight / ln(u), where u is
+     * uniform in (0, 1), so each server gets the share of keys proportional to
+     * its weight.
+     */
+    static double
+    score(uint64_t server, uint32_t key, double weight, bool weighted) {
+        uint64_t hash = mix64(server ^ key);
+        if (!weighted) return double(hash);
+        double uniform = (double(hash >> 11) + 0.5) * 0x1p-53;
+        return -weight / std::log(uniform);
+    }
+
+    /** Returns index of the server with the highest score for given key.
+     */
+    value_type best(uint32_t key) const {
+        value_type result = 0;
+        double top = score(seeds[0], key, weights[0], weighted);
+        for (std::size_t i = 1; i < seeds.size(); ++i) {
+            double value = score(seeds[i], key, weights[i], weighted);
+            if (top < value) {
+                top = value;
+                result = static_cast<value_type>(i);
+            }
+        }
+        return result;
+    }
+
+    /** Fills the ranking with scores of all servers for given key, the server
+     * with the highest score is at the front.
+     */
+    void rank(uint32_t key, ranking_t &ranking) const {
+        ranking.nodes.clear();
+        ranking.nodes.reserve(seeds.size());
+        for (std::size_t i = 0; i < seeds.size(); ++i) {
+            double value = score(seeds[i], key, weights[i], weighted);
+            ranking.nodes.emplace_back(value, static_cast<value_type>(i));
+            // keep the best server at the front
+            if (ranking.nodes.front().first < value)
+                std::swap(ranking.nodes.front(), ranking.nodes.back());
+        }
+    }
+
+    /** Returns count of servers.
+     */
+    std::size_t size() const { return seeds.size();}
+
+protected:
+    /** C'tor.
+     */
+    rendezvous_pool_base_t(const std::vector<double> &weights)
+        : seeds(), weights(weights), weighted(false)
+    {}
+
+    std::vector<uint64_t> seeds;  //!< hashes of server addresses
+    std::vector<double> weights;  //!< server weights
+    bool weighted;                //!< false if all weights are equal
+};
+
+/** Parent type for const iterator of the rendezvous_pool_t.
+ */
+typedef std::iterator<
+            std::forward_iterator_tag,
+            const rendezvous_pool_base_t::value_type
+        > rendezvous_pool_const_iterator_parent_t;
+
+/** Const iterator that yields servers in descending score order. The servers
+ * are ordered lazily: choose() finds the best one only, without any
+ * allocation, and the ranking of the rest is built by the first step of
+ * failover that then selects one server per step. Each iterator owns its
+ * ranking so the copies are independent.
+ */
+class rendezvous_pool_const_iterator
+    : public rendezvous_pool_const_iterator_parent_t
+{
+public:
+    // shortcuts and standard iterators stuff
+    typedef rendezvous_pool_const_iterator_parent_t parent_t;
+    typedef parent_t::reference reference;
+    typedef parent_t::pointer pointer;
+    typedef parent_t::value_type value_type;
+    typedef rendezvous_pool_base_t::ranking_t ranking_t;
+    typedef rendezvous_pool_base_t::value_type index_t;
+
+    /** C'tor.
+     * @param pool the servers.
+     * @param key hash of the key.
+     * @param best index of server with the highest score for the key.
+     */
+    inline rendezvous_pool_const_iterator(const rendezvous_pool_base_t *pool,
+                                          uint32_t key,
+                                          index_t best)
+        : pool(pool), key(key), ordered(false), pos(), current(best),
+          ranking()
+    {}
+
+    /** C'tor that yields servers in order of their indices.
+     */
+    explicit inline
+    rendezvous_pool_const_iterator(const rendezvous_pool_base_t *pool)
+        : pool(pool), key(), ordered(true), pos(), current(), ranking()
+    {}
+
+    /** C'tor.
+     */
+    inline rendezvous_pool_const_iterator()
+        : pool(), key(), ordered(true), pos(), current(), ranking()
+    {}
+
+    /** Returns reference to current value.
+     */
+    inline reference operator*() const { return current;}
+
+    /** Returns pointer to current value.
+     */
+    inline pointer operator->() const { return &**this;}
+
+    /** Moves to next item.
+     */
+    inline rendezvous_pool_const_iterator &operator++() {
+        increment();
+        return *this;
+    }
+
+    /** Returns iterator to current item and moves to next one.
+     */
+    inline rendezvous_pool_const_iterator operator++(int) {
+        rendezvous_pool_const_iterator tmp(*this);
+        ++(*this);
+        return tmp;
+    }
+
+    /** Returns true if iterators points to same place.
+     */
+    inline bool equal(const rendezvous_pool_const_iterator &other) const {
+        if (at_end()) return other.at_end();
+        return (pool == other.pool) && (ordered == other.ordered)
+            && (key == other.key) && (pos == other.pos);
+    }
+
+protected:
+    /** Returns true if there is no more server.
+     */
+    inline bool at_end() const { return !pool || (pos >= pool->size());}
+
+    /** Moves to server with next lower score.
+     */
+    inline void increment() {
+        if (at_end()) return;
+        if (++pos >= pool->size()) return;
+        if (ordered) {
+            current = static_cast<index_t>(pos);
+            return;
+        }
+        if (ranking.nodes.empty()) pool->rank(key, ranking);
+        ranking.select(pos - 1);
+        current = ranking.nodes[pos].second;
+    }
+
+    const rendezvous_pool_base_t *pool; //!< servers
+    uint32_t key;                       //!< hash of the key
+    bool ordered;                       //!< servers are yielded by index
+    std::size_t pos;                    //!< position of current server
+    index_t current;                    //!< current server
+    ranking_t ranking;                  //!< servers ordered by score
+};
+
+/** Pool that uses rendezvous (highest random weight) hashing. Each server
+ * gets a score for the key and the key belongs to the server with the
+ * highest score; the next best servers are the failover servers. Removing a
+ * server moves only its own keys and they are spread over all other servers.
+ * The servers may have weights (see rendezvous_pool_config_t), e.g. memory
+ * size of memcache node, and each server gets the share of keys proportional
+ * to its weight. The lookup costs O(count of servers) so the pool suits
+ * small and middle sized clusters.
+ */
+template <typename hash_function_t>
+class rendezvous_pool_t: public rendezvous_pool_base_t {
+public:
+    /// value type
+    using rendezvous_pool_base_t::value_type;
+    /// const iterator type
+    typedef rendezvous_pool_const_iterator const_iterator;
+
+    /** C'tor.
+     * @param addresses list of server addresses.
+     * @param cfg pool config (server weights).
+     */
+    rendezvous_pool_t(const std::vector<std::string> &addresses,
+                      const rendezvous_pool_config_t &
+                      cfg = rendezvous_pool_config_t())
+        : rendezvous_pool_base_t(cfg.weights), hashf()
+    {
+        // at least one address must be supplied
+        if (addresses.empty()) throw std::out_of_range(__PRETTY_FUNCTION__);
+
+        // all servers have the same weight by default
+        if (weights.empty()) weights.resize(addresses.size(), 1.0);
+        if (weights.size() != addresses.size())
+            throw std::invalid_argument("count of weights != count of servers");
+        for (auto weight: weights) {
+            if (!(weight > 0)) throw std::invalid_argument("weight <= 0");
+            if (weight != weights.front()) weighted = true;
+        }
+
+        // the server identity is its address
+        seeds.reserve(addresses.size());
+        for (auto &address: addresses) seeds.push_back(mix64(hashf(address)));
+    }
+
+    /* Returns iterator that points to the server with the highest score.
+     */
+    const_iterator choose(const std::string &key) const {
+        uint32_t hash = hashf(key);
+        return const_iterator(this, hash, best(hash));
+    }
+
+    /* Returns iterator that points to the first server.
+     */
+    const_iterator begin() const { return const_iterator(this);}
+
+    /** Returns iterator one past last server.
+     */
+    const_iterator end() const { return const_iterator();}
+
+protected:
+    hash_function_t hashf; //!< hash functor
+};
+
+/** Comparison operator==.
+ */
+inline bool operator==(const rendezvous_pool_const_iterator &lhs,
+                       const rendezvous_pool_const_iterator &rhs)
+{
+    return lhs.equal(rhs);
+}
+
+/** Comparison operator!=.
+ */
+inline bool operator!=(const rendezvous_pool_const_iterator &lhs,
+                       const rendezvous_pool_const_iterator &rhs)
+{
+    return !lhs.equal(rhs);
+}
+
+} // namespace mc
+
+#endif /* MCACHE_POOL_RENDEZVOUS_H */
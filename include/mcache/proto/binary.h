@@ -23,10 +23,13 @@
 
 #include <arpa/inet.h>
 #include <string>
+#include <vector>
+#include <utility>
 
 #include <mcache/time-units.h>
 #include <mcache/proto/opts.h>
 #include <mcache/proto/response.h>
+#include <mcache/proto/parser.h>
 #include <mcache/proto/zlib.h>
 
 namespace mc {
@@ -44,16 +47,31 @@ public:
      */
     std::size_t header_delimiter() const { return 24;}
 
+    /** Sets the value that server copies back to the response.
+     */
+    void set_opaque(uint32_t value) { opaque = value;}
+
+    /** Returns count of opaque values that the command occupies.
+     */
+    uint32_t opaques() const { return 1;}
+
+    /** Returns opaque value of the response with given header; it allows
+     * pipelined connection to route the response to its request.
+     */
+    static uint32_t response_opaque(const std::string &header);
+
 protected:
     /** C'tor.
      */
     command_t(uint16_t key_len, uint32_t body_len = 0, uint8_t extras_len = 0)
-        : extras_len(extras_len), key_len(key_len), body_len(body_len)
+        : extras_len(extras_len), key_len(key_len), body_len(body_len),
+          opaque()
     {}
 
     uint8_t extras_len; //!< the length of extra info in packet
     uint16_t key_len;   //!< the length of the key
     uint32_t body_len;  //!< length in bytes of extra + key + value
+    uint32_t opaque;    //!< will be copied back to response
 };
 
 /** Base class for all retrieve commands.
@@ -185,6 +203,11 @@ public:
     std::string serialize() const;
 
     const std::string key; //!< for which key data should be retrieved
+
+protected:
+    /** Serialize delete command with given code (delete or deleteq).
+     */
+    std::string serialize(uint8_t code) const;
 };
 
 /** Class that implements touch command.
@@ -268,6 +291,100 @@ private:
     static const std::size_t extras_length = 4;
 };
 
+/** Class that implements version command. It is cheap so it is used to probe
+ * the server health.
+ */
+class version_command_t: public command_t {
+public:
+    /** C'tor.
+     */
+    version_command_t(): command_t(static_cast<uint16_t>(0)) {}
+
+    /** Deserialize responses for version command; the version of server is
+     * the body of response.
+     */
+    response_t deserialize_header(const std::string &header) const;
+
+    /** Serialize version command.
+     */
+    std::string serialize() const;
+};
+
+/** Class that implements batch of commands. The commands are sent at once
+ * and terminated by noop command. Each command is tagged with its index in
+ * the batch (via opaque) so the quiet commands, that don't send response in
+ * the case of success, could be used.
+ */
+template <typename command_type>
+class multi_command_t: public command_t {
+public:
+    // publish command type
+    typedef command_type item_command_t;
+    // response for batch
+    typedef multi_response_t<
+                item_response_t<typename item_command_t::response_t>
+            > response_t;
+    // response for one item
+    typedef typename response_t::item_t item_t;
+
+    /** C'tor: batch of commands that have key argument only.
+     */
+    template <typename key_t>
+    explicit multi_command_t(const std::vector<key_t> &keys)
+        : command_t(0), commands()
+    {
+        commands.reserve(keys.size());
+        for (auto &key: keys) commands.emplace_back(key);
+        set_opaques();
+    }
+
+    /** C'tor: batch of storage commands that shares options.
+     */
+    template <typename value_t>
+    multi_command_t(const std::vector<std::pair<std::string, value_t>> &items,
+                    const opts_t &opts)
+        : command_t(0), commands()
+    {
+        commands.reserve(items.size());
+        for (auto &item: items)
+            commands.emplace_back(item.first, item.second, opts);
+        set_opaques();
+    }
+
+    /** Deserialize one response in batch.
+     */
+    item_t deserialize_header(const std::string &header, std::size_t) const;
+
+    /** Serialize all commands in batch.
+     */
+    std::string serialize() const;
+
+    /** Sets the first opaque of the batch; the commands are tagged by
+     * consecutive values and the closing noop by the last one.
+     */
+    void set_opaque(uint32_t value) {
+        opaque = value;
+        set_opaques();
+    }
+
+    /** Returns count of opaque values that the batch occupies (commands and
+     * closing noop).
+     */
+    uint32_t opaques() const {
+        return static_cast<uint32_t>(commands.size() + 1);
+    }
+
+protected:
+    /** Tags each command by its index (shifted by the first opaque).
+     */
+    void set_opaques() {
+        for (std::size_t i = 0; i < commands.size(); ++i)
+            commands[i].set_opaque(opaque + static_cast<uint32_t>(i));
+    }
+
+    std::vector<item_command_t> commands; //!< batch of commands
+};
+
 /** Injects name to particular command class.
  */
 template <typename parent_t, uint8_t code>
@@ -337,6 +454,9 @@ public:
     // protocol api table
     typedef op_code_injector<retrieve_command_t, get_code> get_t;
     typedef op_code_injector<retrieve_command_t, gets_code> gets_t;
+    typedef op_code_injector<retrieve_command_t, getkq_code> getkq_t;
+    typedef multi_command_t<getkq_t> get_multi_t;
+    typedef multi_command_t<getkq_t> gets_multi_t;
     typedef op_code_injector<storage_command_t<true>, set_code> set_t;
     typedef op_code_injector<storage_command_t<true>, add_code> add_t;
     typedef op_code_injector<storage_command_t<true>, replace_code> replace_t;
@@ -348,9 +468,27 @@ public:
     typedef op_code_injector<touch_command_t, touch_code> touch_t;
     typedef delete_command_t delete_t;
     typedef flush_all_command_t flush_all_t;
+    typedef version_command_t version_t;
+
+    // quiet commands (server responds in the case of failure only)
+    typedef op_code_injector<storage_command_t<true>, setq_code> setq_t;
+    typedef op_code_injector<storage_command_t<true>, addq_code> addq_t;
+    typedef op_code_injector<delete_command_t, deleteq_code> deleteq_t;
+    typedef multi_command_t<setq_t> set_multi_t;
+    typedef multi_command_t<addq_t> add_multi_t;
+    typedef multi_command_t<deleteq_t> delete_multi_t;
 };
 
 } // namespace bin
+
+/** The get commands are batched as getkq commands closed by noop.
+ */
+template <>
+class batch_of<bin::api::get_t> {
+public:
+    typedef bin::api::get_multi_t type;
+};
+
 } // namespace proto
 } // namespace mc
 
@@ -21,6 +21,16 @@
 #define MCACHE_PROTO_PARSER_H
 
 #include <string>
+#include <memory>
+#include <utility>
+#include <future>
+#include <optional>
+#include <exception>
+#include <type_traits>
+
+#include <mcache/io/error.h>
+#include <mcache/io/buffer.h>
+#include <mcache/proto/response.h>
 
 namespace mc {
 namespace proto {
@@ -38,8 +48,72 @@ struct has_set_body<
     )
 > {static constexpr bool value = true;};
 
+template <typename, typename = bool>
+struct is_multi_response {static constexpr bool value = false;};
+
+template <typename response_t>
+struct is_multi_response<
+    response_t,
+    decltype(std::declval<typename response_t::item_t>(), true)
+> {static constexpr bool value = true;};
+
+template <typename, typename = bool>
+struct has_opaque {static constexpr bool value = false;};
+
+template <typename command_t>
+struct has_opaque<
+    command_t,
+    decltype(
+        command_t::response_opaque(std::declval<std::string>()),
+        std::declval<command_t>().set_opaque(std::declval<command_t>().opaques()),
+        true
+    )
+> {static constexpr bool value = true;};
+
+template <typename, typename = bool>
+struct is_async_connection {static constexpr bool value = false;};
+
+template <typename connection_t>
+struct is_async_connection<
+    connection_t,
+    decltype(std::declval<typename connection_t::reader_t>(), true)
+> {static constexpr bool value = true;};
+
+template <typename, typename = bool>
+struct is_pipelined_connection {static constexpr bool value = false;};
+
+template <typename connection_t>
+struct is_pipelined_connection<
+    connection_t,
+    decltype(std::declval<connection_t>().reserve(0u), true)
+> {static constexpr bool value = true;};
+
+/** Returns true if the response is a well-formed reply so the responses
+ * that follow it on the connection can still be parsed. The error replies
+ * (e.g. value too large) belong to their own request only.
+ */
+inline bool is_well_formed(int code) {
+    switch (code) {
+    case resp::empty:
+    case resp::syntax:
+    case resp::invalid:
+    case resp::unrecognized:
+        return false;
+    default:
+        return true;
+    }
+}
+
 } // namespace aux
 
+/** Maps command to the multi command that carries many of them in one batch.
+ * The server proxy merges concurrent commands of the same server into the
+ * batch (see server_proxy_config_t::batch_window). The protocols specialize
+ * it for the commands that can be batched.
+ */
+template <typename command_t>
+class batch_of {};
+
 /** This class provides interface for serializing and deserializing commands to
  * io object.
  */
@@ -54,20 +128,136 @@ public:
 
     /** Sends command to memcache server.
      */
-    template <typename command_t>
-    typename command_t::response_t send(const command_t &command) {
+    template <typename command_t, typename conn_t = connection_t>
+    std::enable_if_t<
+        !aux::is_async_connection<conn_t>::value,
+        typename command_t::response_t
+    > send(const command_t &command) {
         // send serialized command to server
         connection->write(command.serialize());
         // deserialize server command response
         return deserialize_response(command);
     }
 
+    /** Sends command to memcache server via async connection and waits for
+     * response. The connection may carry requests of other threads at the
+     * same time. It must not be called from the reactor thread.
+     */
+    template <typename command_t, typename conn_t = connection_t>
+    std::enable_if_t<
+        aux::is_async_connection<conn_t>::value,
+        typename command_t::response_t
+    > send(const command_t &command) {
+        typedef typename command_t::response_t response_t;
+        std::promise<response_t> promise;
+        auto result = promise.get_future();
+        async_send(command, [&promise] (response_t &&response) {
+            promise.set_value(std::move(response));
+        });
+        return result.get();
+    }
+
+    /** Sends command to memcache server via async connection. The callback
+     * gets the response once it arrives; the i/o errors are reported as
+     * io_error responses. If both command and connection support opaques
+     * the command is tagged by unique opaque and its response is routed by
+     * it.
+     */
+    template <typename command_t, typename callback_t>
+    void async_send(const command_t &command, callback_t &&callback) {
+        typedef typename command_t::response_t response_t;
+        auto response = std::make_shared<std::optional<response_t>>();
+        auto tagged = tag(command);
+        send_tagged(
+            tagged.first.serialize(),
+            [command = tagged.first, response] (io::buffer_t &input) {
+                try {
+                    command_parser_t<io::buffer_t> parser(input);
+                    response->emplace(parser.receive(command));
+                    return aux::is_well_formed((*response)->code());
+
+                } catch (const mc::error_t &e) {
+                    // the rest of response can't be parsed
+                    response->emplace(resp::error, e.what());
+                    return false;
+                }
+            },
+            [response, callback = std::forward<callback_t>(callback)]
+            (std::exception_ptr error) mutable {
+                if (!error) return callback(std::move(**response));
+                try {
+                    std::rethrow_exception(error);
+                } catch (const std::exception &e) {
+                    callback(response_t(resp::io_error,
+                                        std::string("connection failed: ")
+                                        + e.what()));
+                }
+            },
+            std::move(tagged.second)
+        );
+    }
+
+    /** Deserializes server response of command that has been already sent.
+     */
+    template <typename command_t>
+    typename command_t::response_t receive(const command_t &command) {
+        return deserialize_response(command);
+    }
+
 protected:
+    /** Dummy tag of request that is dispatched in order.
+     */
+    class untagged_t {};
+
+    /** Tags the copy of the command by opaques reserved from connection.
+     */
+    template <typename command_t>
+    auto tag(const command_t &command) {
+        if constexpr (aux::has_opaque<command_t>::value
+                      && aux::is_pipelined_connection<connection_t>::value) {
+            typename connection_t::tag_t tag;
+            command_t tagged(command);
+            tag.count = tagged.opaques();
+            tag.opaque = connection->reserve(tag.count);
+            tag.router = [size = tagged.header_delimiter()]
+                         (const io::buffer_t &input) {
+                return command_t::response_opaque(input.peek(size));
+            };
+            tagged.set_opaque(tag.opaque);
+            return std::make_pair(std::move(tagged), std::move(tag));
+        } else {
+            return std::make_pair(command, untagged_t());
+        }
+    }
+
+    /** Sends tagged request via connection.
+     */
+    template <typename reader_t, typename handler_t, typename tag_t>
+    void send_tagged(std::string data, reader_t &&reader, handler_t &&handler,
+                     tag_t &&tag)
+    {
+        connection->send(std::move(data), std::forward<reader_t>(reader),
+                         std::forward<handler_t>(handler),
+                         std::forward<tag_t>(tag));
+    }
+
+    /** Sends request that is dispatched in order via connection.
+     */
+    template <typename reader_t, typename handler_t>
+    void send_tagged(std::string data, reader_t &&reader, handler_t &&handler,
+                     untagged_t)
+    {
+        connection->send(std::move(data), std::forward<reader_t>(reader),
+                         std::forward<handler_t>(handler));
+    }
+
     /** Deserializes server response for single response commands.
      */
     template <typename command_t>
-    typename command_t::response_t
-    deserialize_response(const command_t &command) {
+    std::enable_if_t<
+        !aux::is_multi_response<typename command_t::response_t>::value,
+        typename command_t::response_t
+    > deserialize_response(const command_t &command) {
         // fetch response header (txt: first line of response)
         typedef typename command_t::response_t response_t;
         std::string header = connection->read(command.header_delimiter());
@@ -78,6 +268,28 @@ protected:
         return response;
     }
 
+    /** Deserializes server responses for multi commands. The responses are
+     * read until the command recognizes the one that closes the batch.
+     */
+    template <typename command_t>
+    std::enable_if_t<
+        aux::is_multi_response<typename command_t::response_t>::value,
+        typename command_t::response_t
+    > deserialize_response(const command_t &command) {
+        typedef typename command_t::response_t response_t;
+        typedef typename response_t::item_t item_t;
+        response_t response(resp::ok);
+        for (std::size_t index = 0;; ++index) {
+            // fetch item header (txt: one line of response)
+            std::string header = connection->read(command.header_delimiter());
+            item_t item = command.deserialize_header(header, index);
+
+            // if item contains body then fetch it too
+            deserialize_body(item);
+            if (!response.push_back(std::move(item))) return response;
+        }
+    }
+
     /** Response expects body so retrieve and parse it.
      */
     template <typename response_t>
@@ -21,6 +21,8 @@
 #define MCACHE_PROTO_RESPONSE_H
 
 #include <string>
+#include <vector>
+#include <utility>
 #include <functional>
 #include <cstdint>
 
@@ -180,8 +182,68 @@ private:
     }
 };
 
-// TODO(burlog): add support for multi-get
-// here should be vector of single and api for geting data by key
+/** Response for one key of multi commands. It is the single response of
+ * the command extended by the key that the response belongs to.
+ */
+template <typename parent_type>
+class item_response_t: public parent_type {
+public:
+    // publish parent type
+    typedef parent_type parent_t;
+
+    /** C'tor.
+     */
+    item_response_t(const std::string &key,
+                    const parent_t &response,
+                    bool fence = false)
+        : parent_t(response), key(key), fence(fence)
+    {}
+
+    std::string key; //!< the key of the response
+    bool fence;      //!< true if no more items follows
+};
+
+/** Response for multi commands that send many requests in one batch. The
+ * items are pushed to the response in order as they have been read from
+ * connection until the item that closes the batch arrives.
+ */
+template <typename item_type>
+class multi_response_t: public single_response_t {
+public:
+    // publish item type
+    typedef item_type item_t;
+    // type of items storage
+    typedef std::vector<item_t> items_t;
+
+    /** C'tor.
+     */
+    explicit multi_response_t(resp::response_code_t status,
+                              const std::string &aux = std::string())
+        : single_response_t(status, aux), items()
+    {}
+
+    /** Appends item to the response. The item that closes the batch is not
+     * stored but its status becomes the status of whole response.
+     * @return false if no more items follows.
+     */
+    bool push_back(item_t &&item) {
+        if (item.fence) {
+            status = static_cast<resp::response_code_t>(item.code());
+            aux = item.data();
+            return false;
+        }
+        items.push_back(std::move(item));
+        return true;
+    }
+
+    items_t items; //!< responses for particular keys
+};
+
+/** Response for multi retrieval commands.
+ */
+typedef multi_response_t<
+            item_response_t<single_retrival_response_t>
+        > multi_retrival_response_t;
 
 } // namespace proto
 } // namespace mc
@@ -22,6 +22,8 @@
 #define MCACHE_PROTO_TXT_H
 
 #include <string>
+#include <vector>
+#include <utility>
 
 #include <mcache/error.h>
 #include <mcache/proto/opts.h>
@@ -65,13 +67,44 @@ public:
      */
     response_t deserialize_header(const std::string &header) const;
 
-    /** The method for setting the body of response. */
+    /** The method for setting the body of response that ends with given
+     * footer (the multi retrieve commands use it too).
+     */
     static void set_body(uint32_t &flags,
                          std::string &body,
-                         const std::string &data);
+                         const std::string &data,
+                         std::size_t footer_size);
 
     const std::string key; //!< for which key data should be retrieved
-    static const std::size_t footer_size = 7; //!< sizeof("\r\nEND\r\n")
+    static constexpr std::size_t footer_size = 7; //!< sizeof("\r\nEND\r\n")
+
+protected:
+    /** Serialize retrieve command.
+     */
+    std::string serialize(const char *name) const;
+};
+
+/** Base class for retrieve commands for many keys at once.
+ */
+class multi_retrieve_command_t: public command_t {
+public:
+    // response for all keys
+    typedef multi_retrival_response_t response_t;
+    // response for one key
+    typedef response_t::item_t item_t;
+
+    /** C'tor.
+     */
+    explicit multi_retrieve_command_t(const std::vector<std::string> &keys)
+        : keys(keys)
+    {}
+
+    /** Deserialize one VALUE response of get and gets commands.
+     */
+    item_t deserialize_header(const std::string &header, std::size_t) const;
+
+    const std::vector<std::string> keys; //!< for which keys data is retrieved
+    static constexpr std::size_t footer_size = 2; //!< sizeof("\r\n")
 
 protected:
     /** Serialize retrieve command.
@@ -174,6 +207,70 @@ public:
     uint32_t expiration; //!< when data should expire in seconds from now
 };
 
+/** Class that implements version command. It is cheap so it is used to probe
+ * the server health.
+ */
+class version_command_t: public command_t {
+public:
+    /** Deserialize responses for version command; the version of server is
+     * the data of response.
+     */
+    response_t deserialize_header(const std::string &header) const;
+
+    /** Serialize version command.
+     */
+    std::string serialize() const;
+};
+
+/** Class that implements batch of commands. The commands are sent at once
+ * and terminated by version command whose response closes the batch. The
+ * responses arrive in the same order as commands was sent.
+ */
+template <typename command_type>
+class multi_command_t: public command_t {
+public:
+    // publish command type
+    typedef command_type item_command_t;
+    // response for batch
+    typedef multi_response_t<
+                item_response_t<typename item_command_t::response_t>
+            > response_t;
+    // response for one item
+    typedef typename response_t::item_t item_t;
+
+    /** C'tor: batch of commands that have key argument only.
+     */
+    template <typename key_t>
+    explicit multi_command_t(const std::vector<key_t> &keys): commands() {
+        commands.reserve(keys.size());
+        for (auto &key: keys) commands.emplace_back(key);
+    }
+
+    /** C'tor: batch of storage commands that shares options.
+     */
+    template <typename value_t>
+    multi_command_t(const std::vector<std::pair<std::string, value_t>> &items,
+                    const opts_t &opts)
+        : commands()
+    {
+        commands.reserve(items.size());
+        for (auto &item: items)
+            commands.emplace_back(item.first, item.second, opts);
+    }
+
+    /** Deserialize response of index-th command in batch.
+     */
+    item_t deserialize_header(const std::string &header,
+                              std::size_t index) const;
+
+    /** Serialize all commands in batch.
+     */
+    std::string serialize() const;
+
+protected:
+    std::vector<item_command_t> commands; //!< batch of commands
+};
+
 /** Injects name to particular command class.
  */
 template <typename parent_t, const char **name>
@@ -224,6 +321,8 @@ public:
     // protocol api table
     typedef name_injector<retrieve_command_t, &get_name> get_t;
     typedef name_injector<retrieve_command_t, &gets_name> gets_t;
+    typedef name_injector<multi_retrieve_command_t, &get_name> get_multi_t;
+    typedef name_injector<multi_retrieve_command_t, &gets_name> gets_multi_t;
     typedef name_injector<storage_command_t, &set_name> set_t;
     typedef name_injector<storage_command_t, &add_name> add_t;
     typedef name_injector<storage_command_t, &replace_name> replace_t;
@@ -235,6 +334,10 @@ public:
     typedef name_injector<incr_decr_command_t, &touch_name> touch_t;
     typedef delete_command_t delete_t;
     typedef flush_all_command_t flush_all_t;
+    typedef version_command_t version_t;
+    typedef multi_command_t<set_t> set_multi_t;
+    typedef multi_command_t<add_t> add_multi_t;
+    typedef multi_command_t<delete_t> delete_multi_t;
 };
 
 } // namespace txt
@@ -20,12 +20,18 @@
 #ifndef MCACHE_SERVER_PROXIES_H
 #define MCACHE_SERVER_PROXIES_H
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <inttypes.h>
+#include <boost/iterator/indirect_iterator.hpp>
 #include <boost/interprocess/anonymous_shared_memory.hpp>
 
 #include <mcache/error.h>
+#include <mcache/latency.h>
+#include <mcache/time-units.h>
 
 namespace mc {
 namespace thread {
@@ -100,50 +106,33 @@ private:
 
 } // namespace ipc
 
-namespace aux {
-
-/** Array of unitialized values.
- */
-template <typename type_t>
-class unitialized_array_t {
-public:
-    /** C'tor.
-     */
-    unitialized_array_t(std::size_t count)
-        : array(reinterpret_cast<type_t *>(::malloc(count * sizeof(type_t))))
-    {}
-
-    /** D'tor.
-     */
-    ~unitialized_array_t() { ::free(array);}
-
-    /** Const element access operator.
-     */
-    const type_t &operator[](std::size_t i) const { return array[i];}
-
-    /** Non-const element access operator.
-     */
-    type_t &operator[](std::size_t i) { return array[i];}
-
-private:
-    type_t *array;     //!< pointer to memory pool
-};
-
-} // namespace aux
-
-/** Vector of server proxies.
+/** Vector of server proxies. The proxies are reference counted so the lists
+ * made for updated set of servers can share the proxies of servers that
+ * remain (including their state and connections). The shared data of the
+ * proxies made at once are allocated in one block (e.g. one shared memory
+ * region for all servers of ipc client). Note that the block made for new
+ * servers after fork() is private to the process that made it.
  */
 template <
     template <typename> class shared_templ_t,
     typename server_proxy_type
 > class server_proxies_t {
+private:
+    // shortcut
+    typedef std::shared_ptr<server_proxy_type> server_proxy_ptr_t;
+
 public:
     // publish server proxy type
     typedef server_proxy_type server_proxy_t;
     // publish server proxy iterator
-    typedef const server_proxy_t *const_iterator;
+    typedef boost::indirect_iterator<
+                typename std::vector<server_proxy_ptr_t>::const_iterator,
+                const server_proxy_t
+            > const_iterator;
     // publish server proxy iterator
-    typedef server_proxy_t *iterator;
+    typedef boost::indirect_iterator<
+                typename std::vector<server_proxy_ptr_t>::iterator
+            > iterator;
     // publish server proxy type
     typedef typename server_proxy_t::server_proxy_config_type
             server_proxy_config_t;
@@ -152,18 +141,45 @@ public:
      */
     server_proxies_t(const std::vector<std::string> &addresses,
                      const server_proxy_config_t &cfg = server_proxy_config_t())
-        : shared(addresses.size()), proxies(addresses.size()),
-          count(addresses.size())
+        : cfg(cfg), addresses(addresses), proxies(),
+          total(std::make_shared<total_array_t>(1)),
+          evaluation(time_point_t::min())
+    {
+        auto block = std::make_shared<shared_array_t>(addresses.size());
+        proxies.reserve(addresses.size());
+        for (std::size_t i = 0; i < addresses.size(); ++i)
+            proxies.push_back(make(addresses[i], block, i));
+    }
+
+    /** C'tor. Makes proxies for new list of servers; the proxies of servers
+     * that are in the previous list are reused.
+     */
+    server_proxies_t(const std::vector<std::string> &addresses,
+                     const server_proxies_t &previous)
+        : cfg(previous.cfg), addresses(addresses), proxies(),
+          total(previous.total), evaluation(time_point_t::min())
     {
-        for (std::vector<std::string>::const_iterator
-                iaddr = addresses.begin(),
-                saddr = addresses.begin(),
-                eaddr = addresses.end();
-                iaddr != eaddr; ++iaddr)
-        {
-            // initialize server proxy inplace via placement new operator
-            std::size_t i = std::distance(saddr, iaddr);
-            new (&proxies[i]) server_proxy_t(*iaddr, &shared[i], cfg);
+        // the new servers get one block of shared data
+        std::vector<std::size_t> kept;
+        std::size_t fresh = 0;
+        for (auto &address: addresses) {
+            auto iaddr = std::find(previous.addresses.begin(),
+                                   previous.addresses.end(),
+                                   address);
+            if (iaddr == previous.addresses.end()) {
+                kept.push_back(previous.addresses.size());
+                ++fresh;
+            } else kept.push_back(std::size_t(std::distance(
+                                      previous.addresses.begin(), iaddr)));
+        }
+        std::shared_ptr<shared_array_t> block;
+        if (fresh) block = std::make_shared<shared_array_t>(fresh);
+
+        proxies.reserve(addresses.size());
+        for (std::size_t i = 0, slot = 0; i < addresses.size(); ++i) {
+            if (kept[i] < previous.addresses.size())
+                proxies.push_back(previous.proxies[kept[i]]);
+            else proxies.push_back(make(addresses[i], block, slot++));
         }
     }
 
@@ -171,41 +187,102 @@ public:
     server_proxies_t(const server_proxies_t &) = delete;
     server_proxies_t &operator=(const server_proxies_t &) = delete;
 
-    /** D'tor.
+    /** Compares the latencies of servers and ejects the slow ones (see
+     * aux::find_outliers()) if the ejection is configured. The servers are
+     * compared once per interval, the other calls return immediately, so it
+     * is meant to be called before each command.
      */
-    ~server_proxies_t() {
-        // if server_proxy_t throws than bad things can happen...
-        for (std::size_t i = 0; i < count; ++i) proxies[i].~server_proxy_t();
+    void eject_outliers() {
+        if (!(cfg.outliers.factor > 0)) return;
+        auto now = std::chrono::system_clock::now();
+        time_point_t scheduled = evaluation.load();
+        if (now < scheduled) return;
+        if (!evaluation.compare_exchange_strong(scheduled,
+                                                now + cfg.outliers.interval))
+            return;
+
+        // ejected servers have no samples
+        std::vector<const latency_t *> latencies;
+        for (auto &proxy: proxies)
+            latencies.push_back(proxy->is_ejected(now)? nullptr:
+                                                        &proxy->latency());
+        microseconds_t median;
+        for (auto idx: aux::find_outliers(latencies, cfg.outliers, median))
+            proxies[idx]->eject(now + cfg.outliers.ejection, median);
+
+        // the sketches follow recent latencies
+        for (auto &proxy: proxies) proxy->latency().decay();
     }
 
+    /** Returns count of commands in flight of all servers (the lists made
+     * for updated set of servers share it).
+     */
+    uint64_t load() const { return (*total)[0].load();}
+
+    /** Returns count of servers.
+     */
+    std::size_t size() const { return proxies.size();}
+
     /** Returns server proxy at index i.
      */
-    server_proxy_t &operator[](std::size_t i) { return proxies[i];}
+    server_proxy_t &operator[](std::size_t i) { return *proxies[i];}
 
     /* Returns const iterator that points to the first server proxy.
      */
-    const_iterator begin() const { return &proxies[0];}
+    const_iterator begin() const { return const_iterator(proxies.begin());}
 
     /** Returns const iterator one past last server proxy.
      */
-    const_iterator end() const { return &proxies[count - 1] + 1;}
+    const_iterator end() const { return const_iterator(proxies.end());}
 
     /* Returns iterator that points to the first server proxy.
      */
-    iterator begin() { return &proxies[0];}
+    iterator begin() { return iterator(proxies.begin());}
 
     /** Returns iterator one past last server proxy.
      */
-    iterator end() { return &proxies[count - 1] + 1;}
+    iterator end() { return iterator(proxies.end());}
 
 private:
     // shortcuts
-    typedef aux::unitialized_array_t<server_proxy_t> proxies_t;
     typedef shared_templ_t<typename server_proxy_t::shared_t> shared_array_t;
+    typedef shared_templ_t<std::atomic<uint64_t>> total_array_t;
+
+    /** Server proxy that keeps the block with its shared data alive.
+     */
+    class entry_t {
+    public:
+        /** C'tor.
+         */
+        entry_t(const std::string &address, const server_proxy_config_t &cfg,
+                const std::shared_ptr<shared_array_t> &block,
+                std::size_t slot,
+                const std::shared_ptr<total_array_t> &total)
+            : block(block), total(total),
+              proxy(address, &(*block)[slot], cfg, &(*total)[0])
+        {}
+
+        std::shared_ptr<shared_array_t> block; //!< shared data of proxies
+        std::shared_ptr<total_array_t> total;  //!< load of all servers
+        server_proxy_t proxy;                  //!< server proxy
+    };
+
+    /** Makes new server proxy that keeps its entry alive.
+     */
+    server_proxy_ptr_t make(const std::string &address,
+                            const std::shared_ptr<shared_array_t> &block,
+                            std::size_t slot) const
+    {
+        auto entry = std::make_shared<entry_t>(address, cfg, block, slot,
+                                               total);
+        return server_proxy_ptr_t(entry, &entry->proxy);
+    }
 
-    shared_array_t shared; //!< shared data for proxies
-    proxies_t proxies;     //!< server proxies vector
-    std::size_t count;     //!< count of servers
+    server_proxy_config_t cfg;                //!< config for new proxies
+    std::vector<std::string> addresses;       //!< addresses of servers
+    std::vector<server_proxy_ptr_t> proxies;  //!< server proxies vector
+    std::shared_ptr<total_array_t> total;     //!< load of all servers
+    std::atomic<time_point_t> evaluation;     //!< next check of latencies
 };
 
 } // namespace mc
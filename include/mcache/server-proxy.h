@@ -22,11 +22,21 @@
 #define MCACHE_SERVER_PROXY_H
 
 #include <ctime>
+#include <mutex>
+#include <memory>
 #include <string>
+#include <vector>
 #include <atomic>
+#include <typeinfo>
+#include <exception>
+#include <algorithm>
+#include <type_traits>
+#include <condition_variable>
 #include <inttypes.h>
 
 #include <mcache/lock.h>
+#include <mcache/circuit-breaker.h>
+#include <mcache/latency.h>
 #include <mcache/io/opts.h>
 #include <mcache/io/error.h>
 #include <mcache/proto/response.h>
@@ -48,6 +58,31 @@ void log_server_is_dead(const std::string &srv,
                         seconds_t restoration_interval,
                         const std::string &reason);
 
+/** Just push line to log.
+ */
+void log_server_circuit_open(const std::string &srv,
+                             milliseconds_t backoff,
+                             const std::string &reason);
+
+/** Just push line to log.
+ */
+void log_server_circuit_closed(const std::string &srv);
+
+/** Just push line to log.
+ */
+void log_server_ejected(const std::string &srv,
+                        milliseconds_t ejection,
+                        microseconds_t average,
+                        microseconds_t median);
+
+/** Just push line to log.
+ */
+void log_server_returned(const std::string &srv);
+
+/** Just push line to log.
+ */
+void log_server_probed(const std::string &srv);
+
 /** Composes string with info about current server proxy state.
  */
 std::string make_state_string(const std::string &srv,
@@ -56,6 +91,15 @@ std::string make_state_string(const std::string &srv,
                               uint32_t fails,
                               uint32_t dead);
 
+template <typename, typename = bool>
+struct is_batchable {static constexpr bool value = false;};
+
+template <typename command_t>
+struct is_batchable<
+    command_t,
+    decltype(std::declval<typename proto::batch_of<command_t>::type>(), true)
+> {static constexpr bool value = true;};
+
 } // namespace aux
 
 /** Configuration object for server proxy and connection objects.
@@ -68,15 +112,31 @@ public:
                           uint32_t fail_limit = 1,
                           io::opts_t io_opts = io::opts_t())
         : restoration_interval(restoration_interval), fail_limit(fail_limit),
-          io_opts(io_opts)
+          io_opts(io_opts), batch_window(0us), batch_limit(64), breaker(),
+          outliers()
     {}
 
-    seconds_t restoration_interval; //!< time when reconnect is scheduled
-    uint32_t fail_limit;            //!< # of fails after that srv become dead
-    io::opts_t io_opts;             //!< io options
+    seconds_t restoration_interval;     //!< time when reconnect is scheduled
+    uint32_t fail_limit;                //!< # of fails after that srv is dead
+    io::opts_t io_opts;                 //!< io options
+    microseconds_t batch_window;        //!< how long gets wait (0=off)
+    std::size_t batch_limit;            //!< max count of commands in batch
+    circuit_breaker_config_t breaker;   //!< circuit breaker (window 0 = off)
+    outlier_ejection_config_t outliers; //!< ejection of slow servers
 };
 
 /** Memcache server proxy responsible for handling dead servers.
+ *
+ * By default the server is marked dead after fail_limit consecutive failures
+ * and one caller is let through after each restoration_interval. If circuit
+ * breaker window is configured then the circuit_breaker_t decides instead:
+ * the server is dead while the breaker is open or half open.
+ *
+ * If batch window is configured then the commands that can be batched (see
+ * proto::batch_of, e.g. binary get) are not sent immediately. The first
+ * command opens the batch and waits the window long for other threads, that
+ * call the same server, to join. Then whole batch is sent as one multi
+ * command (getkq + noop) and each waiting thread picks its response.
  */
 template <
     typename lock_t,
@@ -95,23 +155,39 @@ public:
         /** C'tor.
          */
         shared_t()
-            : restoration(time_point_t::min()), dead(false), fails(), lock()
+            : restoration(time_point_t::min()), dead(false), fails(), load(),
+              lock(), breaker(), latency(), ejected(time_point_t::min()),
+              checked(time_point_t::min())
         {}
 
         std::atomic<time_point_t> restoration; //!< when reconnect is scheduled
         std::atomic<uint32_t> dead;            //!< true if server is dead
         std::atomic<uint32_t> fails;           //!< current count of fails
+        std::atomic<uint32_t> load;            //!< count of commands in flight
         lock_t lock;                           //!< for reconnect critical sec
+        circuit_breaker_t breaker;             //!< circuit breaker state
+        latency_t latency;                     //!< latencies of commands
+        std::atomic<time_point_t> ejected;     //!< till when srv is ejected
+        std::atomic<time_point_t> checked;     //!< till when srv is probed
     };
 
     /** C'tor.
+     * @param address address of server.
+     * @param shared shared data of server.
+     * @param cfg proxy config.
+     * @param total count of commands in flight of all servers (or null).
      */
     server_proxy_t(const std::string &address,
                    shared_t *shared,
-                   const server_proxy_config_t &cfg)
+                   const server_proxy_config_t &cfg,
+                   std::atomic<uint64_t> *total = nullptr)
         : restoration_interval(cfg.restoration_interval),
-          fail_limit(cfg.fail_limit), shared(shared),
-          connections(address, cfg.io_opts)
+          fail_limit(cfg.fail_limit), shared(shared), total(total),
+          connections(address, cfg.io_opts),
+          batch_window(cfg.batch_window),
+          batch_limit(std::max<std::size_t>(cfg.batch_limit, 1)),
+          batch_mutex(), batch_closed(), batch(), breaker(cfg.breaker),
+          outliers(cfg.outliers)
     {}
 
     /** Returns true if server is dead.
@@ -123,11 +199,26 @@ public:
      * this method.
      */
     bool callable() {
+        // the slow server is skipped like the dead one till ejection expires
+        if (shared->ejected.load() != time_point_t::min()) {
+            time_point_t until = shared->ejected.load();
+            if (std::chrono::system_clock::now() < until) return false;
+            if (shared->ejected.compare_exchange_strong(until,
+                                                        time_point_t::min()))
+                aux::log_server_returned(connections.server_name());
+        }
+
         // if server is not marked dead return immediately
         if (!shared->dead.load()) return true;
 
-        // check wether we shloud try make dead server alive
+        // the health checker probes the dead server instead of the callers
         auto now = std::chrono::system_clock::now();
+        if (now < shared->checked.load()) return false;
+
+        // the breaker lets the probes through on its own
+        if (breaker.window.count()) return shared->breaker.allow(breaker, now);
+
+        // check wether we shloud try make dead server alive
         if (now < shared->restoration.load()) return false;
 
         // if we don't get lock returns immediately
@@ -141,10 +232,65 @@ public:
         return true;
     }
 
+    /** Makes callable() leave the dead server to the health checker till
+     * given time point (the checker promises to probe it till then).
+     */
+    void watch(time_point_t until) { shared->checked.store(until);}
+
+    /** Probes the dead server by given command (e.g. version) and makes it
+     * alive if the server responds. It is meant to be called periodically by
+     * the health checker thread; the callable() refuses the dead server till
+     * the checker is expected to call again, so the requests never wait for
+     * the probe. The probing respects the circuit breaker if it is on.
+     * @param probe the probe command.
+     * @param interval how often the health checker calls.
+     * @return true if server is alive.
+     */
+    template <typename command_t>
+    bool check_health(const command_t &probe, milliseconds_t interval) {
+        // the checker that missed few rounds is considered gone
+        auto now = std::chrono::system_clock::now();
+        watch(now + 3 * interval);
+        if (!shared->dead.load()) return true;
+        if (breaker.window.count() && !shared->breaker.allow(breaker, now))
+            return false;
+
+        // the connection is not returned to pool if probe fails
+        typedef typename command_t::response_t response_t;
+        std::string error;
+        try {
+            connection_ptr_t connection = connections.pick();
+            proto::command_parser_t<connection_t> parser(*connection);
+            auto start = std::chrono::steady_clock::now();
+            response_t response = parser.send(probe);
+            if (response.code() == proto::resp::ok) {
+                connections.push_back(connection);
+                succeeded(start);
+                if (shared->dead.load()) return false;
+                if (!breaker.window.count())
+                    aux::log_server_probed(connections.server_name());
+                return true;
+            }
+            error = response.data();
+        } catch (const io::error_t &e) {
+            error = e.what();
+        }
+
+        // the legacy dead server just stays dead (no log per probe)
+        if (breaker.window.count()) failed(error);
+        return false;
+    }
+
     /** Returns time duration since last dead mark.
      */
     seconds_t lifespan() const {
         auto now = std::chrono::system_clock::now();
+        if (breaker.window.count()) {
+            if (shared->breaker.opened() == time_point_t::min())
+                return seconds_since_epoch(now);
+            auto result = now - shared->breaker.opened();
+            return std::max(std::chrono::duration_cast<seconds_t>(result), 0s);
+        }
         if (shared->restoration.load() == time_point_t::min())
             return seconds_since_epoch(now);
         auto result = now - (shared->restoration.load() - restoration_interval);
@@ -157,15 +303,142 @@ public:
      */
     template <typename command_t>
     typename command_t::response_t send(const command_t &command) {
+        load_guard_t guard(shared, total);
+        if constexpr (aux::is_batchable<command_t>::value) {
+            if (batch_window.count()) return send_batched(command);
+        }
+        return send_direct(command);
+    }
+
+    /** Call command on server asynchronously. It requires connections that
+     * can carry many requests at once (async connections). The callback is
+     * called with parsed response from reactor thread.
+     * @param command some command.
+     * @param callback called with the command response.
+     */
+    template <typename command_t, typename callback_t>
+    void async_send(const command_t &command, callback_t &&callback) {
+        typedef typename command_t::response_t response_t;
+        auto guard = std::make_shared<load_guard_t>(shared, total);
+        connection_ptr_t connection = connections.pick();
+        proto::command_parser_t<connection_t> parser(*connection);
+        auto start = std::chrono::steady_clock::now();
+        parser.async_send(
+            command,
+            [this, guard, start, callback = std::forward<callback_t>(callback)]
+            (response_t &&response) mutable {
+                // io errors are the only ones that make server dead
+                if (response.code() == proto::resp::io_error)
+                    failed(response.data());
+                else succeeded(start);
+                guard.reset();
+                callback(std::move(response));
+            }
+        );
+        connections.push_back(connection);
+    }
+
+    /** Returns latency statistics of server.
+     */
+    latency_t &latency() { return shared->latency;}
+
+    /** Returns true if server is ejected for its latency.
+     */
+    bool is_ejected(time_point_t now) const {
+        return now < shared->ejected.load();
+    }
+
+    /** Takes slow server out of rotation till given time. Its latency
+     * statistics are forgotten so when it returns it is judged by new
+     * samples only.
+     * @param until when the server returns.
+     * @param median median latency of all servers (for log).
+     */
+    void eject(time_point_t until, microseconds_t median) {
+        auto now = std::chrono::system_clock::now();
+        aux::log_server_ejected(connections.server_name(),
+                                std::chrono::duration_cast<milliseconds_t>(
+                                    until - now),
+                                shared->latency.average(), median);
+        shared->ejected.store(until);
+        shared->latency.reset();
+    }
+
+    /** Returns count of commands in flight (of all threads/processes).
+     */
+    uint32_t load() const { return shared->load.load();}
+
+    /** Returns current state of server proxy.
+     */
+    std::string state() const {
+        return aux::make_state_string(connections.server_name(),
+                                      connections.size(),
+                                      seconds_since_epoch(
+                                          shared->restoration.load()),
+                                      shared->fails.load(),
+                                      shared->dead.load());
+    }
+
+protected:
+    /** Counts the command in flight while it lives.
+     */
+    class load_guard_t {
+    public:
+        /** C'tor.
+         */
+        load_guard_t(shared_t *shared, std::atomic<uint64_t> *total)
+            : shared(shared), total(total)
+        {
+            ++shared->load;
+            if (total) ++*total;
+        }
+
+        /** D'tor.
+         */
+        ~load_guard_t() {
+            --shared->load;
+            if (total) --*total;
+        }
+
+        // don't copy
+        load_guard_t(const load_guard_t &) = delete;
+        load_guard_t &operator=(const load_guard_t &) = delete;
+
+    private:
+        shared_t *shared;             //!< shared data of server
+        std::atomic<uint64_t> *total; //!< load of all servers
+    };
+
+    /** Commands waiting for the batch to be sent.
+     */
+    class batch_t {
+    public:
+        const std::type_info *type;           //!< type of batched commands
+        std::vector<std::string> keys;        //!< keys of batched commands
+        std::shared_ptr<const void> response; //!< response of whole batch
+        std::exception_ptr error;             //!< batch can't be sent
+        bool done = false;                    //!< true if batch is finished
+        std::condition_variable finished;     //!< signals finished batch
+    };
+
+    /** Call command on server immediately and process server connection
+     * errors.
+     */
+    template <typename command_t>
+    typename command_t::response_t send_direct(const command_t &command) {
         // pick connection from pool of connections
         typedef typename command_t::response_t response_t;
         try {
             // if command was finished successfuly then make server alive
             connection_ptr_t connection = connections.pick();
             proto::command_parser_t<connection_t> parser(*connection);
+            auto start = std::chrono::steady_clock::now();
             response_t response = parser.send(command);
-            shared->dead.store(false);
-            shared->fails.store(0);
+
+            // the async connections report io errors as responses
+            if (response.code() == proto::resp::io_error)
+                failed(response.data());
+            else succeeded(start);
 
             // if command does not understand repsonse then does not return the
             // connection to pool (the connection will be closed)
@@ -174,20 +447,7 @@ public:
             return response;
 
         } catch (const io::error_t &e) {
-            // lock, destroy whole pool of connections and mark server as dead
-            scope_guard_t<lock_t> guard(shared->lock);
-            if (guard.try_lock()) {
-                if (++shared->fails >= fail_limit) {
-                    auto now = std::chrono::system_clock::now();
-                    connections.clear();
-                    shared->restoration.store(now + restoration_interval);
-                    shared->dead.store(true);
-                    aux::log_server_is_dead(connections.server_name(),
-                                            fail_limit,
-                                            restoration_interval,
-                                            e.what());
-                }
-            }
+            failed(e.what());
             return response_t(proto::resp::io_error,
                               std::string("connection failed: ") + e.what());
         }
@@ -195,21 +455,149 @@ public:
         throw std::runtime_error(__PRETTY_FUNCTION__);
     }
 
-    /** Returns current state of server proxy.
+    /** Joins the command to the open batch (or opens new one) and waits
+     * till the batch is finished. The thread that has opened the batch sends
+     * it once the window expires or the batch is full.
      */
-    std::string state() const {
-        return aux::make_state_string(connections.server_name(),
-                                      connections.size(),
-                                      shared->restoration.load(),
-                                      shared->fails.load(),
-                                      shared->dead.load());
+    template <typename command_t>
+    typename command_t::response_t send_batched(const command_t &command) {
+        typedef typename proto::batch_of<command_t>::type batch_command_t;
+        typedef typename batch_command_t::response_t batch_response_t;
+
+        // join the open batch or open new one and become its leader
+        std::unique_lock<std::mutex> guard(batch_mutex);
+        if (batch && (*batch->type != typeid(command_t))) {
+            guard.unlock();
+            return send_direct(command);
+        }
+        bool leader = !batch;
+        if (leader) {
+            batch = std::make_shared<batch_t>();
+            batch->type = &typeid(command_t);
+        }
+        std::shared_ptr<batch_t> current = batch;
+        current->keys.push_back(command.key);
+
+        // close the full batch so the next command opens new one
+        if (current->keys.size() >= batch_limit) {
+            batch.reset();
+            batch_closed.notify_all();
+        }
+
+        if (leader) {
+            // wait for other commands and send whole batch
+            batch_closed.wait_for(guard, batch_window,
+                                  [&] { return batch != current;});
+            if (batch == current) batch.reset();
+            guard.unlock();
+            try {
+                current->response = std::make_shared<batch_response_t>(
+                        send_direct(batch_command_t(current->keys)));
+            } catch (...) {
+                current->error = std::current_exception();
+            }
+            guard.lock();
+            current->done = true;
+            current->finished.notify_all();
+
+        } else {
+            current->finished.wait(guard, [&] { return current->done;});
+        }
+        guard.unlock();
+
+        // the batch has been rejected (e.g. bad key) so send command alone
+        if (current->error) return send_direct(command);
+        return pick_response(
+                command,
+                *std::static_pointer_cast<const batch_response_t>(
+                    current->response));
     }
 
-protected:
-    seconds_t restoration_interval; //!< timeout for dead server
-    uint32_t fail_limit;            //!< # of fails after that srv become dead
-    shared_t *shared;               //!< shared data with other threads
-    connections_t connections;      //!< connections pool
+    /** Returns the response of the command from batch response.
+     */
+    template <typename command_t, typename batch_response_t>
+    static typename command_t::response_t
+    pick_response(const command_t &command, const batch_response_t &batch) {
+        typedef typename command_t::response_t response_t;
+        if (batch.code() >= proto::resp::error) {
+            return response_t(static_cast<proto::resp::response_code_t>(
+                                  batch.code()),
+                              batch.data());
+        }
+        for (auto &item: batch.items)
+            if (item.key == command.key) return response_t(item);
+        return response_t(proto::resp::not_found);
+    }
+
+    /** Makes server alive after successfuly finished command and records its
+     * latency.
+     */
+    void succeeded(std::chrono::steady_clock::time_point start) {
+        if (outliers.factor > 0) {
+            auto end = std::chrono::steady_clock::now();
+            shared->latency.record(
+                    std::chrono::duration_cast<microseconds_t>(end - start),
+                    outliers.alpha);
+        }
+        if (breaker.window.count()) {
+            auto now = std::chrono::system_clock::now();
+            auto transition = shared->breaker.record(breaker, now, true);
+            if (transition == circuit_breaker_t::recovered)
+                aux::log_server_circuit_closed(connections.server_name());
+            else if (shared->breaker.state() != circuit_breaker_t::closed)
+                return;
+        }
+        shared->dead.store(false);
+        shared->fails.store(0);
+    }
+
+    /** Counts the server failure and marks server as dead (and destroys whole
+     * pool of connections) if fail limit has been reached.
+     */
+    void failed(const std::string &reason) {
+        if (breaker.window.count()) {
+            ++shared->fails;
+            auto now = std::chrono::system_clock::now();
+            auto transition = shared->breaker.record(breaker, now, false);
+            if (transition == circuit_breaker_t::tripped) {
+                connections.clear();
+                shared->restoration.store(shared->breaker.retry());
+                shared->dead.store(true);
+                aux::log_server_circuit_open(
+                        connections.server_name(),
+                        std::chrono::duration_cast<milliseconds_t>(
+                            shared->breaker.retry() - now),
+                        reason);
+            }
+            return;
+        }
+        scope_guard_t<lock_t> guard(shared->lock);
+        if (guard.try_lock()) {
+            if (++shared->fails >= fail_limit) {
+                auto now = std::chrono::system_clock::now();
+                connections.clear();
+                shared->restoration.store(now + restoration_interval);
+                shared->dead.store(true);
+                aux::log_server_is_dead(connections.server_name(),
+                                        fail_limit,
+                                        restoration_interval,
+                                        reason);
+            }
+        }
+    }
+
+    seconds_t restoration_interval;       //!< timeout for dead server
+    uint32_t fail_limit;                  //!< # of fails to make srv dead
+    shared_t *shared;                     //!< shared data with other threads
+    std::atomic<uint64_t> *total;         //!< load of all servers (or null)
+    connections_t connections;            //!< connections pool
+    microseconds_t batch_window;          //!< how long gets wait for batch
+    std::size_t batch_limit;              //!< max count of commands in batch
+    std::mutex batch_mutex;               //!< guards open batch
+    std::condition_variable batch_closed; //!< signals closed batch
+    std::shared_ptr<batch_t> batch;       //!< batch that accepts commands
+    circuit_breaker_config_t breaker;     //!< circuit breaker config
+    outlier_ejection_config_t outliers;   //!< ejection of slow servers
 };
 
 } // namespace mc
@@ -24,8 +24,10 @@ namespace mc {
 
 using std::chrono_literals::operator""s;
 using std::chrono_literals::operator""ms;
+using std::chrono_literals::operator""us;
 using seconds_t = std::chrono::seconds;
 using milliseconds_t = std::chrono::milliseconds;
+using microseconds_t = std::chrono::microseconds;
 using time_point_t = std::chrono::system_clock::time_point;
 
 inline seconds_t seconds_since_epoch(const time_point_t &tp) {
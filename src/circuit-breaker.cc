@@ -0,0 +1,199 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Circuit breaker of memcache server proxy.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <random>
+#include <algorithm>
+
+#include "mcache/circuit-breaker.h"
+
+namespace mc {
+namespace {
+
+/** Returns index of slice of time of sliding window.
+ */
+uint32_t slice(const circuit_breaker_config_t &cfg, time_point_t now) {
+    auto length = std::max<int64_t>(cfg.window.count()
+                                    / int64_t(circuit_breaker_t::buckets), 1);
+    return static_cast<uint32_t>(std::chrono::duration_cast<milliseconds_t>(
+            now.time_since_epoch()).count() / length);
+}
+
+/** The bucket of sliding window is one word: the upper half holds the index
+ * of slice of time (modulo 2^32) and the lower half holds the counts of
+ * succeeded and failed requests. So the bucket is reused and counted by
+ * single compare and swap and no result is lost or counted in a wrong slice.
+ */
+uint32_t epoch_of(uint64_t bucket) { return uint32_t(bucket >> 32);}
+uint32_t successes_of(uint64_t bucket) { return uint16_t(bucket >> 16);}
+uint32_t failures_of(uint64_t bucket) { return uint16_t(bucket);}
+
+/** Returns bucket made of given parts.
+ */
+uint64_t make_bucket(uint32_t epoch, uint32_t successes, uint32_t failures) {
+    return (uint64_t(epoch) << 32) | (uint64_t(successes) << 16) | failures;
+}
+
+/** Returns bucket with the result of one more request. The counts are halved
+ * when one of them would overflow, so the bucket keeps the failure rate.
+ */
+uint64_t count(uint64_t bucket, uint32_t epoch, bool success) {
+    uint32_t successes = 0;
+    uint32_t failures = 0;
+    if (epoch_of(bucket) == epoch) {
+        successes = successes_of(bucket);
+        failures = failures_of(bucket);
+        if (std::max(successes, failures) == UINT16_MAX) {
+            successes /= 2;
+            failures /= 2;
+        }
+    }
+    if (success) ++successes;
+    else ++failures;
+    return make_bucket(epoch, successes, failures);
+}
+
+} // namespace
+
+circuit_breaker_t::circuit_breaker_t()
+    : current(closed), trips(0), probes(0), passed(0),
+      since(time_point_t::min()), until(time_point_t::min())
+{
+    for (auto &bucket: window) bucket.store(0);
+}
+
+bool circuit_breaker_t::allow(const circuit_breaker_config_t &cfg,
+                              time_point_t now)
+{
+    switch (current.load()) {
+    case closed:
+    case closing:
+        return true;
+
+    case open: {
+        // the backoff has expired so start probing
+        if (now < until.load()) return false;
+        uint32_t expected = open;
+        if (current.compare_exchange_strong(expected, half_open))
+            until.store(now + backoff(cfg));
+        break;
+    }
+
+    case half_open: {
+        // the probes haven't reported in time so start new round of probes
+        time_point_t deadline = until.load();
+        if (now < deadline) break;
+        if (until.compare_exchange_strong(deadline, now + backoff(cfg))) {
+            passed.store(0);
+            probes.store(0);
+        }
+        break;
+    }
+
+    default:
+        return false;
+    }
+    return (current.load() == half_open) && (probes++ < cfg.probes);
+}
+
+circuit_breaker_t::transition_t
+circuit_breaker_t::record(const circuit_breaker_config_t &cfg,
+                          time_point_t now,
+                          bool success)
+{
+    switch (current.load()) {
+    case closed:
+        break;
+
+    case half_open:
+        if (!success) return trip(cfg, now, half_open)? tripped: none;
+        if (++passed >= cfg.probes) {
+            uint32_t expected = half_open;
+            if (!current.compare_exchange_strong(expected, closing))
+                return none;
+            for (auto &bucket: window) bucket.store(0);
+            trips.store(0);
+            current.store(closed);
+            return recovered;
+        }
+        return none;
+
+    default:
+        // the results of requests sent before the breaker opened
+        return none;
+    }
+
+    // count the result in the current bucket (the bucket of expired slice
+    // is reused)
+    uint32_t epoch = slice(cfg, now);
+    auto &bucket = window[epoch % buckets];
+    uint64_t stale = bucket.load();
+    while (!bucket.compare_exchange_weak(stale, count(stale, epoch, success)));
+    if (success) return none;
+
+    // sum the results of the window; the buckets are read one by one, so
+    // the sum may mix results of requests recorded meanwhile, that is fine
+    // for the failure rate
+    uint64_t failures = 0;
+    uint64_t total = 0;
+    for (auto &slot: window) {
+        uint64_t value = slot.load();
+        if (epoch - epoch_of(value) >= buckets) continue;
+        failures += failures_of(value);
+        total += failures_of(value) + successes_of(value);
+    }
+    if ((total < cfg.min_requests)
+        || (double(failures) < cfg.failure_rate * double(total)))
+        return none;
+    return trip(cfg, now, closed)? tripped: none;
+}
+
+bool circuit_breaker_t::trip(const circuit_breaker_config_t &cfg,
+                             time_point_t now,
+                             uint32_t from)
+{
+    // the other requests see the breaker open once it is set up
+    if (!current.compare_exchange_strong(from, tripping)) return false;
+    ++trips;
+    passed.store(0);
+    probes.store(0);
+    since.store(now);
+    until.store(now + backoff(cfg));
+    current.store(open);
+    return true;
+}
+
+milliseconds_t
+circuit_breaker_t::backoff(const circuit_breaker_config_t &cfg) const {
+    // double the backoff for each consecutive opening
+    double length = double(cfg.backoff.count());
+    for (uint32_t i = 1; i < trips.load(); ++i) {
+        length *= 2;
+        if (length >= double(cfg.backoff_limit.count())) break;
+    }
+    length = std::min(length, double(cfg.backoff_limit.count()));
+
+    // cut random part off
+    static thread_local std::minstd_rand generator(std::random_device{}());
+    std::uniform_real_distribution<double> random(0, 1);
+    double jitter = std::min(std::max(cfg.jitter, 0.0), 1.0);
+    length *= 1 - jitter * random(generator);
+    return milliseconds_t(std::max<int64_t>(int64_t(length), 1));
+}
+
+} // namespace mc
@@ -0,0 +1,165 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Benchmark of libmcache hash functions.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+#include <mcache/init.h>
+#include <mcache/hash.h>
+#include <mcache/pool/flat-consistent-hashing.h>
+
+namespace {
+
+/// set of keys of the same length distribution
+struct keys_t {
+    const char *name;              //!< name of the distribution
+    std::vector<std::string> keys; //!< the keys
+};
+
+/** Generates keys that look like memcache keys (prefix, ids and random
+ * suffix) with lengths drawn by given generator.
+ */
+template <typename length_t>
+keys_t generate(const char *name, std::size_t count, length_t length) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789:_-";
+    std::mt19937 random(42);
+    keys_t result{name, {}};
+    result.keys.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t size = std::min<std::size_t>(
+                250, std::max<std::size_t>(8, length(random)));
+        std::string key = "obj:" + std::to_string(i) + ":";
+        while (key.size() < size)
+            key.push_back(alphabet[random() % (sizeof(alphabet) - 1)]);
+        key.resize(size);
+        result.keys.push_back(std::move(key));
+    }
+    return result;
+}
+
+/** Measures throughput of hash function for each key set and the quality of
+ * key distribution over servers in consistent hashing ring.
+ */
+template <typename hash_t>
+void bench(const char *name, const std::vector<keys_t> &sets,
+           const std::vector<std::string> &servers)
+{
+    using clock_t = std::chrono::steady_clock;
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+
+    const int rounds = 10;
+    hash_t hash;
+    for (auto &set: sets) {
+        // the sum prevents the compiler from optimizing the hash out
+        // the keys are hashed several times to keep them in cache
+        uint64_t sum = 0;
+        std::size_t bytes = 0;
+        auto start = clock_t::now();
+        for (int round = 0; round < rounds; ++round) {
+            for (auto &key: set.keys) {
+                sum += hash(key);
+                bytes += key.size();
+            }
+        }
+        auto elapsed = duration_cast<nanoseconds>(clock_t::now() - start);
+        std::cout << std::setw(12) << std::left << name
+                  << std::setw(14) << std::left << set.name
+                  << std::setw(10) << std::right << std::fixed
+                  << std::setprecision(1)
+                  << double(elapsed.count()) / double(rounds)
+                   / double(set.keys.size())
+                  << " ns/key"
+                  << std::setw(10) << std::right
+                  << double(bytes) / double(elapsed.count()) * 1000.0
+                  << " MB/s" << std::endl;
+        if (sum == 42) std::cout << std::endl;
+    }
+
+    // distribution of keys of the last set over servers in the ring
+    mc::flat_consistent_hashing_pool_t<hash_t> pool(servers);
+    std::vector<double> counts(servers.size());
+    for (auto &key: sets.back().keys) ++counts[*pool.choose(key)];
+    double mean = double(sets.back().keys.size()) / double(servers.size());
+    double variance = 0;
+    for (auto count: counts) variance += (count - mean) * (count - mean);
+    variance /= double(counts.size());
+    std::cout << std::setw(12) << std::left << name
+              << std::setw(14) << std::left << "ring"
+              << "stddev=" << std::setprecision(2)
+              << 100.0 * std::sqrt(variance) / mean << "%"
+              << " max/mean=" << std::setprecision(3)
+              << *std::max_element(counts.begin(), counts.end()) / mean
+              << " min/mean="
+              << *std::min_element(counts.begin(), counts.end()) / mean
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    mc::init();
+
+    // params
+    std::size_t count = argc > 1? std::strtoul(argv[1], nullptr, 10): 100000;
+    std::size_t servers_count = argc > 2? std::strtoul(argv[2], nullptr, 10)
+                                        : 60;
+    if (!count || !servers_count) {
+        std::cerr << "Usage: " << argv[0] << " [keys [servers]]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // fixed lengths and the mixed distribution (mostly short keys with long
+    // tail up to the memcache limit)
+    std::vector<keys_t> sets;
+    for (std::size_t size: {8, 16, 32, 64, 128, 250}) {
+        static const char *names[] = {"8B", "16B", "32B", "64B", "128B",
+                                      "250B"};
+        sets.push_back(generate(names[sets.size()], count,
+                                [size] (std::mt19937 &) { return size;}));
+    }
+    sets.push_back(generate("mixed 8-250B", count, [] (std::mt19937 &random) {
+        std::lognormal_distribution<double> distribution(3.3, 0.6);
+        return std::size_t(distribution(random));
+    }));
+
+    std::vector<std::string> servers;
+    for (std::size_t i = 0; i < servers_count; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+
+    std::cout << "crc32c hardware: " << (mc::crc32c_hardware()? "yes": "no")
+              << std::endl;
+    bench<mc::jenkins_t>("jenkins", sets, servers);
+    bench<mc::murmur3_t>("murmur3", sets, servers);
+    bench<mc::city_t>("city", sets, servers);
+    bench<mc::spooky_t>("spooky", sets, servers);
+    bench<mc::xxh3_t>("xxh3", sets, servers);
+    bench<mc::crc32c_t>("crc32c", sets, servers);
+    bench<mc::city64_t>("city64", sets, servers);
+    bench<mc::spooky64_t>("spooky64", sets, servers);
+    bench<mc::xxh3_64_t>("xxh3_64", sets, servers);
+    return EXIT_SUCCESS;
+}
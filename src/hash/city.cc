@@ -607,5 +607,9 @@ uint32_t city(const void *buf, std::size_t size, uint32_t seed = 0) {
                     HashLen16(v.second, w.second) + x));
 }
 
+uint64_t city64(const void *buf, std::size_t size, uint64_t seed) {
+    return CityHash64WithSeed(reinterpret_cast<const char *>(buf), size, seed);
+}
+
 } // namespace mc
 
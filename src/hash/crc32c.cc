@@ -0,0 +1,131 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      CRC32C (Castagnoli) hash function.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define MCACHE_CRC32C_SSE42 1
+#endif /* __x86_64__ && __GNUC__ */
+
+#include "mcache/hash/crc32c.h"
+
+namespace mc {
+namespace {
+
+/// reflected Castagnoli polynomial
+const uint32_t polynomial = 0x82f63b78;
+
+/** Lookup tables for slicing-by-4 crc computation.
+ */
+class tables_t {
+public:
+    tables_t() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int j = 0; j < 8; ++j)
+                crc = (crc >> 1) ^ (polynomial & (0u - (crc & 1)));
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int j = 1; j < 4; ++j) {
+                uint32_t prev = table[j - 1][i];
+                table[j][i] = (prev >> 8) ^ table[0][prev & 0xff];
+            }
+        }
+    }
+
+    uint32_t table[4][256]; //!< crc of byte followed by 0..3 zero bytes
+};
+
+/** Table driven (portable) crc32c.
+ */
+uint32_t software(uint32_t crc, const uint8_t *data, std::size_t size) {
+    static const tables_t tables;
+    auto &table = tables.table;
+    for (; size >= 4; size -= 4, data += 4) {
+        crc ^= uint32_t(data[0]) | (uint32_t(data[1]) << 8)
+             | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+        crc = table[3][crc & 0xff] ^ table[2][(crc >> 8) & 0xff]
+            ^ table[1][(crc >> 16) & 0xff] ^ table[0][crc >> 24];
+    }
+    for (; size; --size, ++data)
+        crc = (crc >> 8) ^ table[0][(crc ^ *data) & 0xff];
+    return crc;
+}
+
+#ifdef MCACHE_CRC32C_SSE42
+
+/** Crc32c computed by the SSE4.2 crc32 instruction.
+ */
+__attribute__((target("sse4.2")))
+uint32_t hardware(uint32_t crc, const uint8_t *data, std::size_t size) {
+    uint64_t crc64 = crc;
+    for (; size >= 8; size -= 8, data += 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    if (size & 4) {
+        uint32_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+        data += 4;
+    }
+    if (size & 2) {
+        uint16_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u16(crc, word);
+        data += 2;
+    }
+    if (size & 1) crc = _mm_crc32_u8(crc, *data);
+    return crc;
+}
+
+/** Returns implementation suitable for the cpu.
+ */
+uint32_t (*dispatch())(uint32_t, const uint8_t *, std::size_t) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2")? hardware: software;
+}
+
+#else /* MCACHE_CRC32C_SSE42 */
+
+/** Returns implementation suitable for the cpu.
+ */
+uint32_t (*dispatch())(uint32_t, const uint8_t *, std::size_t) {
+    return software;
+}
+
+#endif /* MCACHE_CRC32C_SSE42 */
+
+} // namespace
+
+uint32_t crc32c(const void *buf, std::size_t size, uint32_t seed) {
+    static auto *implementation = dispatch();
+    const uint8_t *data = static_cast<const uint8_t *>(buf);
+    return ~implementation(~seed, data, size);
+}
+
+bool crc32c_hardware() {
+    return dispatch() != software;
+}
+
+} // namespace mc
@@ -665,4 +665,8 @@ uint32_t spooky(const void *buf, std::size_t size, uint32_t seed) {
     return SpookyHash::Hash32(buf, size, seed);
 }
 
+uint64_t spooky64(const void *buf, std::size_t size, uint64_t seed) {
+    return SpookyHash::Hash64(buf, size, seed);
+}
+
 } // namespace mc
@@ -0,0 +1,350 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      XXH3 (64bit) hash function by Yann Collet.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft (scalar port of XXH3_64bits_withSeed).
+ */
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif /* __SSE2__ */
+
+#include "mcache/hash/xxhash.h"
+
+namespace mc {
+namespace {
+
+const uint64_t prime32_1 = 0x9e3779b1U;
+const uint64_t prime32_2 = 0x85ebca77U;
+const uint64_t prime32_3 = 0xc2b2ae3dU;
+const uint64_t prime64_1 = 0x9e3779b185ebca87ULL;
+const uint64_t prime64_2 = 0xc2b2ae3d27d4eb4fULL;
+const uint64_t prime64_3 = 0x165667b19e3779f9ULL;
+const uint64_t prime64_4 = 0x85ebca77c2b2ae63ULL;
+const uint64_t prime64_5 = 0x27d4eb2f165667c5ULL;
+
+const std::size_t stripe_len = 64;
+const std::size_t secret_size = 192;
+const std::size_t secret_consume_rate = 8;
+const std::size_t secret_lastacc_start = 7;
+const std::size_t secret_mergeaccs_start = 11;
+const std::size_t mid_size_max = 240;
+
+/// default XXH3 secret
+const uint8_t default_secret[secret_size] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c,
+    0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+    0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e,
+    0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6,
+    0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+    0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+    0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7,
+    0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+    0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83,
+    0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26,
+    0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+    0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f,
+    0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+inline uint32_t swap32(uint32_t value) { return __builtin_bswap32(value);}
+inline uint64_t swap64(uint64_t value) { return __builtin_bswap64(value);}
+
+/** Reads little endian 32bit integer from unaligned memory.
+ */
+inline uint32_t read32(const uint8_t *ptr) {
+    uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = swap32(value);
+#endif /* __BYTE_ORDER__ */
+    return value;
+}
+
+/** Reads little endian 64bit integer from unaligned memory.
+ */
+inline uint64_t read64(const uint8_t *ptr) {
+    uint64_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = swap64(value);
+#endif /* __BYTE_ORDER__ */
+    return value;
+}
+
+/** Writes little endian 64bit integer to unaligned memory.
+ */
+inline void write64(uint8_t *ptr, uint64_t value) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = swap64(value);
+#endif /* __BYTE_ORDER__ */
+    std::memcpy(ptr, &value, sizeof(value));
+}
+
+inline uint64_t rotl64(uint64_t value, int count) {
+    return (value << count) | (value >> (64 - count));
+}
+
+/** Multiplies two 64bit integers and folds 128bit result to 64 bits.
+ */
+inline uint64_t mul128_fold64(uint64_t lhs, uint64_t rhs) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 product = (unsigned __int128)lhs * rhs;
+    return uint64_t(product) ^ uint64_t(product >> 64);
+#else /* __SIZEOF_INT128__ */
+    uint64_t lo_lo = (lhs & 0xffffffff) * (rhs & 0xffffffff);
+    uint64_t hi_lo = (lhs >> 32) * (rhs & 0xffffffff);
+    uint64_t lo_hi = (lhs & 0xffffffff) * (rhs >> 32);
+    uint64_t hi_hi = (lhs >> 32) * (rhs >> 32);
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+    uint64_t upper = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    uint64_t lower = (cross << 32) | (lo_lo & 0xffffffff);
+    return lower ^ upper;
+#endif /* __SIZEOF_INT128__ */
+}
+
+/** XXH64 avalanche.
+ */
+inline uint64_t xxh64_avalanche(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= prime64_2;
+    hash ^= hash >> 29;
+    hash *= prime64_3;
+    return hash ^ (hash >> 32);
+}
+
+/** XXH3 avalanche.
+ */
+inline uint64_t avalanche(uint64_t hash) {
+    hash ^= hash >> 37;
+    hash *= 0x165667919e3779f9ULL;
+    return hash ^ (hash >> 32);
+}
+
+/** XXH3 avalanche used for 4-8 bytes long inputs.
+ */
+inline uint64_t rrmxmx(uint64_t hash, uint64_t len) {
+    hash ^= rotl64(hash, 49) ^ rotl64(hash, 24);
+    hash *= 0x9fb21c651e98df25ULL;
+    hash ^= (hash >> 35) + len;
+    hash *= 0x9fb21c651e98df25ULL;
+    return hash ^ (hash >> 28);
+}
+
+inline uint64_t
+mix16(const uint8_t *input, const uint8_t *secret, uint64_t seed) {
+    return mul128_fold64(read64(input) ^ (read64(secret) + seed),
+                         read64(input + 8) ^ (read64(secret + 8) - seed));
+}
+
+uint64_t len_1to3(const uint8_t *input, std::size_t len, uint64_t seed) {
+    uint32_t combined = (uint32_t(input[0]) << 16)
+                      | (uint32_t(input[len >> 1]) << 24)
+                      | uint32_t(input[len - 1])
+                      | (uint32_t(len) << 8);
+    uint64_t flip = (read32(default_secret) ^ read32(default_secret + 4))
+                  + seed;
+    return xxh64_avalanche(uint64_t(combined) ^ flip);
+}
+
+uint64_t len_4to8(const uint8_t *input, std::size_t len, uint64_t seed) {
+    seed ^= uint64_t(swap32(uint32_t(seed))) << 32;
+    uint64_t input64 = read32(input + len - 4)
+                     + (uint64_t(read32(input)) << 32);
+    uint64_t flip = (read64(default_secret + 8) ^ read64(default_secret + 16))
+                  - seed;
+    return rrmxmx(input64 ^ flip, len);
+}
+
+uint64_t len_9to16(const uint8_t *input, std::size_t len, uint64_t seed) {
+    uint64_t flip1 = (read64(default_secret + 24) ^ read64(default_secret + 32))
+                   + seed;
+    uint64_t flip2 = (read64(default_secret + 40) ^ read64(default_secret + 48))
+                   - seed;
+    uint64_t lo = read64(input) ^ flip1;
+    uint64_t hi = read64(input + len - 8) ^ flip2;
+    return avalanche(len + swap64(lo) + hi + mul128_fold64(lo, hi));
+}
+
+uint64_t len_17to128(const uint8_t *input, std::size_t len, uint64_t seed) {
+    const uint8_t *secret = default_secret;
+    uint64_t acc = len * prime64_1;
+    if (len > 32) {
+        if (len > 64) {
+            if (len > 96) {
+                acc += mix16(input + 48, secret + 96, seed);
+                acc += mix16(input + len - 64, secret + 112, seed);
+            }
+            acc += mix16(input + 32, secret + 64, seed);
+            acc += mix16(input + len - 48, secret + 80, seed);
+        }
+        acc += mix16(input + 16, secret + 32, seed);
+        acc += mix16(input + len - 32, secret + 48, seed);
+    }
+    acc += mix16(input, secret, seed);
+    acc += mix16(input + len - 16, secret + 16, seed);
+    return avalanche(acc);
+}
+
+uint64_t len_129to240(const uint8_t *input, std::size_t len, uint64_t seed) {
+    const uint8_t *secret = default_secret;
+    const std::size_t start_offset = 3;
+    const std::size_t last_offset = 17;
+    const std::size_t secret_size_min = 136;
+
+    uint64_t acc = len * prime64_1;
+    std::size_t rounds = len / 16;
+    for (std::size_t i = 0; i < 8; ++i)
+        acc += mix16(input + 16 * i, secret + 16 * i, seed);
+    acc = avalanche(acc);
+    for (std::size_t i = 8; i < rounds; ++i) {
+        acc += mix16(input + 16 * i, secret + 16 * (i - 8) + start_offset,
+                     seed);
+    }
+    acc += mix16(input + len - 16, secret + secret_size_min - last_offset,
+                 seed);
+    return avalanche(acc);
+}
+
+#ifdef __SSE2__
+
+/** Accumulates one 64 bytes long stripe (SSE2 variant).
+ */
+inline void
+accumulate512(uint64_t acc[8], const uint8_t *input, const uint8_t *secret) {
+    __m128i *xacc = reinterpret_cast<__m128i *>(acc);
+    for (std::size_t i = 0; i < 4; ++i) {
+        __m128i value = _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(input) + i);
+        __m128i key = _mm_xor_si128(value, _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(secret) + i));
+        __m128i product = _mm_mul_epu32(
+                key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+        __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+        xacc[i] = _mm_add_epi64(product, _mm_add_epi64(xacc[i], swapped));
+    }
+}
+
+/** Scrambles accumulators after each block (SSE2 variant).
+ */
+inline void scramble(uint64_t acc[8], const uint8_t *secret) {
+    __m128i *xacc = reinterpret_cast<__m128i *>(acc);
+    const __m128i prime = _mm_set1_epi32(int(prime32_1));
+    for (std::size_t i = 0; i < 4; ++i) {
+        __m128i value = _mm_xor_si128(xacc[i], _mm_srli_epi64(xacc[i], 47));
+        __m128i key = _mm_xor_si128(value, _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(secret) + i));
+        __m128i lo = _mm_mul_epu32(key, prime);
+        __m128i hi = _mm_mul_epu32(
+                _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+        xacc[i] = _mm_add_epi64(lo, _mm_slli_epi64(hi, 32));
+    }
+}
+
+#else /* __SSE2__ */
+
+/** Accumulates one 64 bytes long stripe.
+ */
+inline void
+accumulate512(uint64_t acc[8], const uint8_t *input, const uint8_t *secret) {
+    for (std::size_t i = 0; i < 8; ++i) {
+        uint64_t value = read64(input + 8 * i);
+        uint64_t key = value ^ read64(secret + 8 * i);
+        acc[i ^ 1] += value;
+        acc[i] += (key & 0xffffffff) * (key >> 32);
+    }
+}
+
+/** Scrambles accumulators after each block.
+ */
+inline void scramble(uint64_t acc[8], const uint8_t *secret) {
+    for (std::size_t i = 0; i < 8; ++i) {
+        uint64_t value = acc[i] ^ (acc[i] >> 47);
+        acc[i] = (value ^ read64(secret + 8 * i)) * prime32_1;
+    }
+}
+
+#endif /* __SSE2__ */
+
+uint64_t long_input(const uint8_t *input, std::size_t len, uint64_t seed) {
+    // the long inputs use secret derived from seed instead of seed itself
+    uint8_t custom[secret_size];
+    const uint8_t *secret = default_secret;
+    if (seed) {
+        for (std::size_t i = 0; i < secret_size / 16; ++i) {
+            write64(custom + 16 * i, read64(default_secret + 16 * i) + seed);
+            write64(custom + 16 * i + 8, read64(default_secret + 16 * i + 8)
+                                         - seed);
+        }
+        secret = custom;
+    }
+
+    alignas(16) uint64_t acc[8] = {
+        prime32_3, prime64_1, prime64_2, prime64_3,
+        prime64_4, prime32_2, prime64_5, prime32_1
+    };
+    const std::size_t stripes = (secret_size - stripe_len)
+                              / secret_consume_rate;
+    const std::size_t block_len = stripe_len * stripes;
+    const std::size_t blocks = (len - 1) / block_len;
+    for (std::size_t i = 0; i < blocks; ++i) {
+        for (std::size_t j = 0; j < stripes; ++j) {
+            accumulate512(acc, input + i * block_len + j * stripe_len,
+                          secret + j * secret_consume_rate);
+        }
+        scramble(acc, secret + secret_size - stripe_len);
+    }
+
+    // the last partial block and the last stripe
+    const std::size_t last = ((len - 1) - block_len * blocks) / stripe_len;
+    for (std::size_t j = 0; j < last; ++j) {
+        accumulate512(acc, input + blocks * block_len + j * stripe_len,
+                      secret + j * secret_consume_rate);
+    }
+    accumulate512(acc, input + len - stripe_len,
+                  secret + secret_size - stripe_len - secret_lastacc_start);
+
+    // merge accumulators
+    uint64_t result = len * prime64_1;
+    for (std::size_t i = 0; i < 4; ++i) {
+        const uint8_t *key = secret + secret_mergeaccs_start + 16 * i;
+        result += mul128_fold64(acc[2 * i] ^ read64(key),
+                                acc[2 * i + 1] ^ read64(key + 8));
+    }
+    return avalanche(result);
+}
+
+} // namespace
+
+uint64_t xxh3(const void *buf, std::size_t size, uint64_t seed) {
+    const uint8_t *input = static_cast<const uint8_t *>(buf);
+    if (size <= 16) {
+        if (size > 8) return len_9to16(input, size, seed);
+        if (size >= 4) return len_4to8(input, size, seed);
+        if (size) return len_1to3(input, size, seed);
+        return xxh64_avalanche(seed ^ read64(default_secret + 56)
+                                    ^ read64(default_secret + 64));
+    }
+    if (size <= 128) return len_17to128(input, size, seed);
+    if (size <= mid_size_max) return len_129to240(input, size, seed);
+    return long_input(input, size, seed);
+}
+
+} // namespace mc
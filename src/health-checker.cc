@@ -0,0 +1,112 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Background health checker of memcache servers.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <set>
+#include <new>
+#include <exception>
+#include <pthread.h>
+
+#include "error.h"
+#include "mcache/health-checker.h"
+
+namespace mc {
+namespace {
+
+/** Checkers of process; they have to be restarted in forked child.
+ */
+class registry_t {
+public:
+    std::mutex mutex;                      //!< guards checkers
+    std::set<health_checker_t *> checkers; //!< running checkers
+};
+
+/** Returns registry of checkers; it is never destroyed since the checkers
+ * can outlive the static objects.
+ */
+registry_t &registry() {
+    static registry_t *result = new registry_t();
+    return *result;
+}
+
+} // namespace
+
+health_checker_t::health_checker_t(milliseconds_t interval, check_t check)
+    : interval(interval), check(std::move(check)), mutex(), wakeup(),
+      stopping(false), thread()
+{
+    static std::once_flag registered;
+    std::call_once(registered, [] {
+        ::pthread_atfork(&prepare_fork, &parent_fork, &child_fork);
+    });
+
+    // the thread has to see the members initialized
+    std::lock_guard<std::mutex> guard(registry().mutex);
+    thread = std::thread(&health_checker_t::run, this);
+    registry().checkers.insert(this);
+}
+
+health_checker_t::~health_checker_t() {
+    {
+        std::lock_guard<std::mutex> guard(registry().mutex);
+        registry().checkers.erase(this);
+    }
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    thread.join();
+}
+
+void health_checker_t::prepare_fork() {
+    // the mutexes are not held during checks so it doesn't wait for them
+    registry().mutex.lock();
+    for (auto *checker: registry().checkers) checker->mutex.lock();
+}
+
+void health_checker_t::parent_fork() {
+    for (auto *checker: registry().checkers) checker->mutex.unlock();
+    registry().mutex.unlock();
+}
+
+void health_checker_t::child_fork() {
+    for (auto *checker: registry().checkers) {
+        // the handle and waiters of parent thread are dropped without d'tor
+        new (&checker->thread) std::thread();
+        new (&checker->wakeup) std::condition_variable();
+        checker->thread = std::thread(&health_checker_t::run, checker);
+        checker->mutex.unlock();
+    }
+    registry().mutex.unlock();
+}
+
+void health_checker_t::run() {
+    std::unique_lock<std::mutex> guard(mutex);
+    while (!wakeup.wait_for(guard, interval, [this] { return stopping;})) {
+        guard.unlock();
+        try {
+            check();
+        } catch (const std::exception &e) {
+            LOG(ERR2, "Health check failed: error=%s", e.what());
+        }
+        guard.lock();
+    }
+}
+
+} // namespace mc
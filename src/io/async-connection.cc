@@ -0,0 +1,413 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Async I/O object for communication with memcache server.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <deque>
+#include <mutex>
+#include <array>
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/asio/post.hpp>
+
+#include "error.h"
+#include "io/aux.h"
+#include "mcache/io/error.h"
+#include "mcache/io/reactor.h"
+#include "mcache/io/async-connection.h"
+
+// shortcut
+namespace asio = boost::asio;
+
+namespace mc {
+namespace io {
+namespace tcp {
+
+/** Pimple class for async tcp connection. All members are guarded by mutex;
+ * the handlers of finished requests are called out of the lock.
+ */
+class async_connection_t::pimple_connection_t
+    : public std::enable_shared_from_this<pimple_connection_t>,
+      public boost::noncopyable
+{
+public:
+    // shortcuts
+    using this_t = pimple_connection_t;
+    using ptime_t = boost::posix_time::ptime;
+    using guard_t = std::unique_lock<std::mutex>;
+
+    /** Connection state.
+     */
+    enum state_t { idle, connecting, connected, broken};
+
+    /** Request waiting for response.
+     */
+    class request_t {
+    public:
+        std::string data;  //!< serialized request
+        reader_t reader;   //!< response parser
+        handler_t handler; //!< completion handler
+        ptime_t deadline;  //!< when request expires
+        tag_t tag;         //!< opaques of tagged request
+    };
+
+    /** Finished requests whose handlers are called out of lock.
+     */
+    using completions_t = std::vector<std::pair<handler_t, std::exception_ptr>>;
+
+    /** C'tor.
+     */
+    pimple_connection_t(const std::string &addr, const opts_t &opts)
+        : addr(addr), opts(opts),
+          reactor(opts.reactor? opts.reactor: reactor_t::instance()),
+          resolver(reactor->context()), socket(reactor->context()),
+          deadline(reactor->context())
+    {}
+
+    /** Queues request and starts connecting or writing if needed.
+     */
+    void send(std::string data, reader_t reader, handler_t handler,
+              tag_t tag)
+    {
+        guard_t guard(mutex);
+        if (state == broken) {
+            guard.unlock();
+            auto error = make_error(err::io_error, "connection is broken"
+                                    ": dst=" + addr);
+            asio::post(reactor->context(), [handler, error] {handler(error);});
+            return;
+        }
+
+        // the request has to be finished till all timeouts expire
+        auto timeout = opts.timeouts.write + opts.timeouts.read;
+        if (state != connected) timeout += opts.timeouts.connect;
+        waiting.push_back({std::move(data), std::move(reader),
+                           std::move(handler), after(timeout),
+                           std::move(tag)});
+
+        // launch appropriate async op
+        switch (state) {
+        case idle: connect(); break;
+        case connected: if (!writing) write(); break;
+        default: break;
+        }
+        watch();
+    }
+
+    /** Reserves count of consecutive opaque values.
+     */
+    uint32_t reserve(uint32_t count) {
+        return opaques.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /** Closes the socket; handlers of pending requests are called from
+     * reactor thread.
+     */
+    void close() {
+        guard_t guard(mutex);
+        completions_t completions;
+        shutdown(make_error(err::io_error, "connection closed: dst=" + addr),
+                 completions);
+        guard.unlock();
+        for (auto &completion: completions) {
+            asio::post(reactor->context(),
+                       [completion] {completion.first(completion.second);});
+        }
+    }
+
+    /** Returns true if connection has failed.
+     */
+    bool is_broken() const {
+        guard_t guard(mutex);
+        return state == broken;
+    }
+
+private:
+    /** Creates io error.
+     */
+    static std::exception_ptr
+    make_error(err::error_code_t code, const std::string &msg) {
+        return std::make_exception_ptr(io::error_t(code, msg));
+    }
+
+    /** Returns time point after timeout from now.
+     */
+    static ptime_t after(milliseconds_t timeout) {
+        return asio::deadline_timer::traits_type::now()
+             + boost::posix_time::milliseconds(timeout.count());
+    }
+
+    /** Calls handlers of finished requests.
+     */
+    static void finish(completions_t &completions) {
+        for (auto &completion: completions)
+            completion.first(completion.second);
+    }
+
+    /** Resolves server address and connects the socket.
+     */
+    void connect() {
+        state = connecting;
+        auto [host, service] = aux::parse_address(addr);
+        auto self = shared_from_this();
+        resolver.async_resolve(host, service, [self] (auto &&ec, auto &&addrs) {
+            guard_t guard(self->mutex);
+            if (self->state != connecting) return;
+            if (ec) return self->fail(guard, err::io_error, ec.message());
+            asio::async_connect(
+                self->socket, addrs,
+                [self] (auto &&ec, auto &&) {self->handle_connect(ec);}
+            );
+        });
+    }
+
+    /** Starts reading and writing once socket is connected.
+     */
+    void handle_connect(const boost::system::error_code &ec) {
+        guard_t guard(mutex);
+        if (state != connecting) return;
+        if (ec) return fail(guard, err::io_error, ec.message());
+        DBG(DBG3, "Connected to memcache server: server=%s", addr.c_str());
+
+        // requests are small and they are expected to be sent immediately
+        boost::system::error_code ignore;
+        socket.set_option(asio::ip::tcp::no_delay(true), ignore);
+        state = connected;
+        write();
+        read();
+    }
+
+    /** Writes all waiting requests at once.
+     */
+    void write() {
+        if (waiting.empty()) return;
+
+        // responses are expected in the same order as the requests are written
+        output.clear();
+        for (auto &request: waiting) {
+            output.append(request.data);
+            request.data.clear();
+            reading.push_back(std::move(request));
+        }
+        waiting.clear();
+
+        // launch async write
+        writing = true;
+        auto self = shared_from_this();
+        asio::async_write(socket, asio::buffer(output),
+                          [self] (auto &&ec, auto &&) {
+            guard_t guard(self->mutex);
+            self->writing = false;
+            if (self->state != connected) return;
+            if (ec) return self->fail(guard, err::io_error, ec.message());
+            self->write();
+        });
+    }
+
+    /** Reads available data and dispatches responses to requests.
+     */
+    void read() {
+        auto self = shared_from_this();
+        socket.async_read_some(asio::buffer(chunk),
+                               [self] (auto &&ec, std::size_t size) {
+            guard_t guard(self->mutex);
+            if (self->state != connected) return;
+            if (ec) return self->fail(guard, err::io_error, ec.message());
+            self->input.append(self->chunk.data(), size);
+
+            // parse complete responses and continue reading
+            completions_t completions;
+            if (self->dispatch(completions)) self->read();
+            else self->shutdown(make_error(err::io_error, "invalid response"
+                                           ": dst=" + self->addr),
+                                completions);
+            guard.unlock();
+            finish(completions);
+        });
+    }
+
+    /** Parses all complete responses from input buffer.
+     * @return false if input buffer contains garbage.
+     */
+    bool dispatch(completions_t &completions) {
+        std::size_t offset = 0;
+        bool healthy = true;
+        while (healthy && !reading.empty()) {
+            buffer_t buffer(input, offset);
+            std::exception_ptr error;
+            auto request = reading.begin();
+            try {
+                if (request->tag.router) request = route(buffer);
+                healthy = request->reader(buffer);
+            } catch (const incomplete_t &) {
+                break;
+            } catch (...) {
+                error = std::current_exception();
+                healthy = false;
+            }
+            offset = buffer.position();
+            completions.emplace_back(std::move(request->handler), error);
+            reading.erase(request);
+        }
+        input.erase(0, offset);
+
+        // data without request means that the stream is out of sync
+        return healthy && (!reading.empty() || input.empty());
+    }
+
+    /** Returns tagged request that owns the opaque of next response.
+     */
+    std::deque<request_t>::iterator route(const buffer_t &buffer) {
+        uint32_t opaque = reading.front().tag.router(buffer);
+        for (auto irequest = reading.begin(); irequest != reading.end();
+             ++irequest) {
+            // the unsigned arithmetic handles the wrap around of opaques
+            const tag_t &tag = irequest->tag;
+            if (tag.router && (opaque - tag.opaque < tag.count))
+                return irequest;
+        }
+        throw io::error_t(err::io_error, "response with unknown opaque"
+                          ": dst=" + addr + ", opaque="
+                          + std::to_string(opaque));
+    }
+
+    /** Starts deadline timer if it is not running.
+     */
+    void watch() {
+        if (watching) return;
+        ptime_t oldest;
+        if (!reading.empty()) oldest = reading.front().deadline;
+        else if (!waiting.empty()) oldest = waiting.front().deadline;
+        else return;
+
+        // the oldest request expires first
+        watching = true;
+        deadline.expires_at(oldest);
+        auto self = shared_from_this();
+        deadline.async_wait([self] (auto &&) {
+            guard_t guard(self->mutex);
+            self->watching = false;
+            if (self->state == broken) return;
+            if (self->expired()) {
+                return self->fail(guard, err::timeout, "request timeouted"
+                                  ": dst=" + self->addr);
+            }
+            self->watch();
+        });
+    }
+
+    /** Returns true if the oldest request has expired.
+     */
+    bool expired() const {
+        auto now = asio::deadline_timer::traits_type::now();
+        if (!reading.empty()) return reading.front().deadline <= now;
+        if (!waiting.empty()) return waiting.front().deadline <= now;
+        return false;
+    }
+
+    /** Breaks the connection and calls handlers of pending requests.
+     */
+    void fail(guard_t &guard, err::error_code_t code, const std::string &msg) {
+        LOG(ERR3, "Async connection failed: dst=%s, error=%s",
+                  addr.c_str(), msg.c_str());
+        completions_t completions;
+        shutdown(make_error(code, msg), completions);
+        guard.unlock();
+        finish(completions);
+    }
+
+    /** Breaks the connection and collects pending requests.
+     */
+    void shutdown(std::exception_ptr error, completions_t &completions) {
+        if (state == broken) return;
+        state = broken;
+
+        // cancel all async ops
+        boost::system::error_code ignore;
+        resolver.cancel();
+        deadline.cancel(ignore);
+        socket.close(ignore);
+
+        // all pending requests fail
+        for (auto &request: reading)
+            completions.emplace_back(std::move(request.handler), error);
+        for (auto &request: waiting)
+            completions.emplace_back(std::move(request.handler), error);
+        reading.clear();
+        waiting.clear();
+    }
+
+    std::string addr;                   //!< destination address
+    opts_t opts;                        //!< connection options
+    std::shared_ptr<reactor_t> reactor; //!< event loop
+    asio::ip::tcp::resolver resolver;   //!< address resolver
+    asio::ip::tcp::socket socket;       //!< i/o socket
+    asio::deadline_timer deadline;      //!< timeout timer
+    mutable std::mutex mutex;           //!< guards all members
+    state_t state = idle;               //!< connection state
+    bool writing = false;               //!< true if write is in progress
+    bool watching = false;              //!< true if timer is running
+    std::atomic<uint32_t> opaques{0};   //!< next free opaque value
+    std::deque<request_t> waiting;      //!< requests waiting for write
+    std::deque<request_t> reading;      //!< requests waiting for response
+    std::string output;                 //!< data being written
+    std::string input;                  //!< received unparsed data
+    std::array<char, 1 << 16> chunk;    //!< buffer for read op
+};
+
+async_connection_t::async_connection_t(const std::string &addr, opts_t opts)
+    : socket(std::make_shared<pimple_connection_t>(addr, opts))
+{}
+
+async_connection_t::~async_connection_t() {
+    socket->close();
+}
+
+void async_connection_t::send(std::string data,
+                              reader_t reader,
+                              handler_t handler)
+{
+    socket->send(std::move(data), std::move(reader), std::move(handler),
+                 tag_t());
+}
+
+void async_connection_t::send(std::string data,
+                              reader_t reader,
+                              handler_t handler,
+                              tag_t tag)
+{
+    socket->send(std::move(data), std::move(reader), std::move(handler),
+                 std::move(tag));
+}
+
+uint32_t async_connection_t::reserve(uint32_t count) {
+    return socket->reserve(count);
+}
+
+bool async_connection_t::is_broken() const {
+    return socket->is_broken();
+}
+
+} // namespace tcp
+} // namespace io
+} // namespace mc
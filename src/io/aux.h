@@ -0,0 +1,49 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      I/O utils.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#ifndef MCACHE_SRC_IO_AUX_H
+#define MCACHE_SRC_IO_AUX_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <boost/algorithm/string/split.hpp>
+
+#include "mcache/io/error.h"
+
+namespace mc {
+namespace io {
+namespace aux {
+
+/** Splits address string to server, port pair.
+ */
+inline std::pair<std::string, std::string>
+parse_address(const std::string &addr) {
+    std::vector<std::string> parts;
+    boost::split(parts, addr, [] (auto c) {return c == ':';});
+    if (parts.size() != 2)
+        throw error_t(err::argument, "invalid destination address: " + addr);
+    return std::make_pair(parts[0], parts[1]);
+}
+
+} // namespace aux
+} // namespace io
+} // namespace mc
+
+#endif /* MCACHE_SRC_IO_AUX_H */
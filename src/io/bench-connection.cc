@@ -0,0 +1,78 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Benchmark of libmcache connection implementations.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+#include <mcache/init.h>
+#include <mcache/io/connection.h>
+#include <mcache/proto/binary.h>
+#include <mcache/proto/parser.h>
+
+namespace {
+
+/** Runs count of get round trips over given connection type.
+ */
+template <typename connection_t>
+void bench(const char *name, const std::string &addr, std::size_t count) {
+    typedef mc::proto::bin::api api;
+    connection_t connection(addr, mc::io::opts_t());
+    mc::proto::command_parser_t<connection_t> parser(connection);
+    parser.send(api::set_t("bench-connection", std::string(100, 'x')));
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+        auto response = parser.send(api::get_t("bench-connection"));
+        if (!response) throw response.exception();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+    std::cout << std::setw(24) << std::left << name
+              << std::setw(12) << std::right << ns.count() / count << " ns/op"
+              << std::setw(12) << std::right
+              << uint64_t(double(count) * 1e9 / double(ns.count()))
+              << " ops/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    mc::init();
+
+    // params
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " server:port [count]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string addr = argv[1];
+    std::size_t count = argc > 2? std::strtoul(argv[2], nullptr, 10): 100000;
+
+    // sequential get round trips
+    bench<mc::io::tcp::connection_t>("tcp::connection_t", addr, count);
+    bench<mc::io::tcp::poll_connection_t>("tcp::poll_connection_t",
+                                          addr, count);
+    bench<mc::io::tcp::reactor_connection_t>("tcp::reactor_connection_t",
+                                             addr, count);
+    return EXIT_SUCCESS;
+}
@@ -38,6 +38,7 @@
 #include <arpa/inet.h>
 
 #include "error.h"
+#include "io/aux.h"
 #include "mcache/io/error.h"
 #include "mcache/hash/murmur3.h"
 #include "mcache/io/connection.h"
@@ -49,16 +50,8 @@ namespace mc {
 namespace io {
 namespace {
 
-/** Splits address string to server, port pair.
- */
-std::pair<std::string, std::string>
-parse_address(const std::string &addr) {
-    std::vector<std::string> parts;
-    boost::split(parts, addr, [] (auto c) {return c == ':';});
-    if (parts.size() != 2)
-        throw error_t(err::argument, "invalid destination address: " + addr);
-    return std::make_pair(parts[0], parts[1]);
-}
+// push address parser into current namespace
+using aux::parse_address;
 
 #ifdef DEBUG
 /** Dumps buffer data and escape nonprinable characters.
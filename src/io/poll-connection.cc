@@ -0,0 +1,227 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      I/O object based on non-blocking socket and poll().
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "error.h"
+#include "io/aux.h"
+#include "mcache/io/error.h"
+#include "mcache/io/connection.h"
+
+namespace mc {
+namespace io {
+namespace tcp {
+namespace {
+
+/** Returns deadline after given timeout from now.
+ */
+std::chrono::steady_clock::time_point after(milliseconds_t timeout) {
+    return std::chrono::steady_clock::now() + timeout;
+}
+
+/** Returns description of the errno value.
+ */
+std::string errno_message(int value) {
+    char buf[256];
+    return ::strerror_r(value, buf, sizeof(buf));
+}
+
+/** Returns true if errno value means that op would block.
+ */
+bool would_block(int value) {
+#if EAGAIN == EWOULDBLOCK
+    return value == EAGAIN;
+#else /* EAGAIN == EWOULDBLOCK */
+    return (value == EAGAIN) || (value == EWOULDBLOCK);
+#endif /* EAGAIN == EWOULDBLOCK */
+}
+
+/** Opens non-blocking socket for given address.
+ */
+int open_socket(const addrinfo *ai) {
+    int fd = ::socket(ai->ai_family,
+                      ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                      ai->ai_protocol);
+    if (fd < 0) return fd;
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+} // namespace
+
+poll_connection_t::poll_connection_t(const std::string &addr, opts_t opts)
+    : addr(addr), opts(opts), fd(-1)
+{
+    // resolve endpoints
+    auto [host, service] = aux::parse_address(addr);
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *result = nullptr;
+    if (int res = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &result))
+        throw io::error_t(err::io_error, ::gai_strerror(res));
+    std::unique_ptr<addrinfo, decltype(&::freeaddrinfo)>
+        addrs(result, &::freeaddrinfo);
+
+    // try all endpoints till one of them is connected
+    auto deadline = after(opts.timeouts.connect);
+    std::string reason = "no address";
+    for (const addrinfo *ai = addrs.get(); ai; ai = ai->ai_next) {
+        fd = open_socket(ai);
+        if (fd < 0) {
+            reason = errno_message(errno);
+            continue;
+        }
+        try {
+            if (::connect(fd, ai->ai_addr, ai->ai_addrlen) < 0) {
+                // the interrupted connect goes on in background as well
+                if ((errno != EINPROGRESS) && (errno != EINTR))
+                    throw io::error_t(err::io_error, errno_message(errno));
+                wait(POLLOUT, deadline, "connect");
+
+                // check the result of connect
+                int value = 0;
+                socklen_t size = sizeof(value);
+                ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &value, &size);
+                if (value) throw io::error_t(err::io_error, errno_message(value));
+            }
+            DBG(DBG3, "Connected to memcache server: server=%s", addr.c_str());
+            return;
+
+        } catch (const io::error_t &e) {
+            ::close(fd);
+            fd = -1;
+            if (e.code() == err::timeout) throw;
+            reason = e.what();
+        }
+    }
+    throw io::error_t(err::io_error, reason);
+}
+
+poll_connection_t::~poll_connection_t() {
+    if (fd >= 0) ::close(fd);
+}
+
+void poll_connection_t::write(const std::string &data) {
+    DBG(DBG1, "Send buffer with data to server: size=%zd, buffer=%s",
+              data.size(), log::escape(data).c_str());
+
+    // try to send data immediately and poll only if socket buffer is full
+    auto deadline = after(opts.timeouts.write);
+    for (std::size_t sent = 0; sent < data.size();) {
+        ssize_t res = ::send(fd, data.data() + sent, data.size() - sent,
+                             MSG_NOSIGNAL);
+        if (res >= 0) {
+            sent += std::size_t(res);
+        } else if (would_block(errno)) {
+            wait(POLLOUT, deadline, "write");
+        } else if (errno != EINTR) {
+            throw io::error_t(err::io_error, errno_message(errno));
+        }
+    }
+}
+
+std::string poll_connection_t::read(const std::string &delimiter) {
+    auto deadline = after(opts.timeouts.read);
+    std::size_t from = 0;
+    for (;;) {
+        // search only new data (delimiter may overlap previous chunk)
+        auto idx = input.find(delimiter, from);
+        if (idx != std::string::npos) {
+            std::size_t size = idx + delimiter.size();
+            std::string result = input.substr(0, size);
+            input.erase(0, size);
+            return result;
+        }
+        from = input.size() >= delimiter.size()
+             ? input.size() - delimiter.size() + 1
+             : 0;
+        fill(deadline);
+    }
+}
+
+std::string poll_connection_t::read(std::size_t bytes) {
+    auto deadline = after(opts.timeouts.read);
+    while (input.size() < bytes) fill(deadline);
+    std::string result = input.substr(0, bytes);
+    input.erase(0, bytes);
+    return result;
+}
+
+void poll_connection_t::wait(short events, deadline_t deadline, const char *op)
+{
+    for (;;) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+            throw io::error_t(err::timeout, std::string("can't ") + op
+                              + " due to timeout: dst=" + addr);
+        }
+
+        // round the timeout up so poll does not wake up too early
+        auto timeout = std::chrono::ceil<std::chrono::milliseconds>
+                       (deadline - now);
+        pollfd pfd = {fd, events, 0};
+        int res = ::poll(&pfd, 1, int(timeout.count()));
+        if (res > 0) {
+            // the closed descriptor would make poll return immediately
+            if (pfd.revents & POLLNVAL) {
+                throw io::error_t(err::io_error, std::string("can't ") + op
+                                  + " due to invalid socket: dst=" + addr);
+            }
+            if (pfd.revents & (events | POLLERR | POLLHUP)) return;
+        } else if ((res < 0) && (errno != EINTR)) {
+            throw io::error_t(err::io_error, errno_message(errno));
+        }
+    }
+}
+
+void poll_connection_t::fill(deadline_t deadline) {
+    char chunk[1 << 14];
+    for (;;) {
+        // try to read data immediately and poll only if there are none
+        ssize_t res = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (res > 0) {
+            input.append(chunk, std::size_t(res));
+            return;
+        } else if (res == 0) {
+            throw io::error_t(err::io_error, "connection closed by server"
+                              ": dst=" + addr);
+        } else if (would_block(errno)) {
+            wait(POLLIN, deadline, "read");
+        } else if (errno != EINTR) {
+            throw io::error_t(err::io_error, errno_message(errno));
+        }
+    }
+}
+
+} // namespace tcp
+} // namespace io
+} // namespace mc
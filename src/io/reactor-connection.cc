@@ -0,0 +1,241 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      I/O object driven by shared reactor.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <condition_variable>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/post.hpp>
+
+#include "error.h"
+#include "io/aux.h"
+#include "mcache/io/error.h"
+#include "mcache/io/reactor.h"
+#include "mcache/io/connection.h"
+
+// shortcut
+namespace asio = boost::asio;
+
+namespace mc {
+namespace io {
+namespace tcp {
+
+/** Pimple class for tcp connection driven by shared reactor. The writes are
+ * done directly by calling thread while the socket accepts data, the other
+ * i/o operations are launched from calling thread (asio tries them
+ * immediately) and completed by reactor thread. The deadline is watched by
+ * the waiting thread so there is no timer per connection.
+ */
+class reactor_connection_t::pimple_connection_t
+    : public std::enable_shared_from_this<pimple_connection_t>,
+      public boost::noncopyable
+{
+public:
+    // shortcut
+    using this_t = pimple_connection_t;
+    using clock_t = std::chrono::steady_clock;
+
+    /** C'tor.
+     */
+    pimple_connection_t(const std::string &addr, const opts_t &opts)
+        : addr(addr), opts(opts),
+          reactor(opts.reactor? opts.reactor: reactor_t::instance()),
+          socket(reactor->context())
+    {}
+
+    /** Connects the socket to server.
+     */
+    void connect() {
+        // resolve endpoints
+        auto [host, service] = aux::parse_address(addr);
+        auto executor = reactor->context().get_executor();
+        auto addrs = asio::ip::tcp::resolver(executor).resolve(host, service);
+        DBG(DBG2, "Resolved address of memcache server: server=%s, address=%s",
+                  addr.c_str(),
+                  addrs.begin()->endpoint().address().to_string().c_str());
+
+        // launch async connect
+        wait(opts.timeouts.connect, "connect", [&] (auto &&handler) {
+            asio::async_connect(socket, addrs,
+                                [handler] (auto &&ec, auto &&) {
+                handler(ec, 0);
+            });
+        });
+        boost::system::error_code ignore;
+        socket.set_option(asio::ip::tcp::no_delay(true), ignore);
+        socket.non_blocking(true, ignore);
+        DBG(DBG3, "Connected to memcache server: server=%s", addr.c_str());
+    }
+
+    /** Writes data to socket. All data has been written when method returns.
+     * @param data some data to sent to remote server.
+     */
+    void write(const std::string &data) {
+        DBG(DBG1, "Send buffer with data to server: size=%zd, buffer=%s",
+                  data.size(), log::escape(data).c_str());
+        if (broken) throw io::error_t(err::io_error, "connection is broken");
+
+        // no async op is pending so the socket may be written directly
+        std::size_t written = 0;
+        boost::system::error_code error;
+        while (written < data.size()) {
+            written += socket.write_some(asio::buffer(data) + written, error);
+            if (error == asio::error::would_block) break;
+            if (error) throw io::error_t(err::io_error, error.message());
+        }
+        if (written == data.size()) return;
+
+        // the rest is written by reactor (the op may outlive the caller)
+        output.assign(data, written, std::string::npos);
+        wait(opts.timeouts.write, "write", [&] (auto &&handler) {
+            asio::async_write(socket, asio::buffer(output), handler);
+        });
+    }
+
+    /** Reads all data from socket until it contains delimiter. Some data may
+     * wait in input buffer for next read operation.
+     * @param delimiter data delimiter.
+     * @return read data (delimiter is included).
+     */
+    std::string read_until(const std::string &delimiter) {
+        std::size_t size = wait(opts.timeouts.read, "read",
+                                [&] (auto &&handler) {
+            asio::async_read_until(socket, input, delimiter, handler);
+        });
+        return copy_n(input, size);
+    }
+
+    /** Reads count bytes from socket. Some data may wait in input buffer for
+     * next read operation.
+     */
+    std::string read(std::size_t count) {
+        // if there is sufficient bytes in buffer return immediately
+        if (count <= input.size()) return copy_n(input, count);
+
+        // wait for the rest
+        std::size_t transfer = count - input.size();
+        wait(opts.timeouts.read, "read", [&] (auto &&handler) {
+            asio::async_read(socket, input, asio::transfer_at_least(transfer),
+                             handler);
+        });
+        return copy_n(input, count);
+    }
+
+private:
+    /** Completion handler that wakes up waiting thread.
+     */
+    class handler_t {
+    public:
+        /** Stores result of the op and wakes up waiting thread.
+         */
+        void operator()(const boost::system::error_code &ec,
+                        std::size_t size) const
+        {
+            std::lock_guard<std::mutex> guard(self->mutex);
+            self->ec = ec;
+            self->size = size;
+            self->done = true;
+            self->finished.notify_one();
+        }
+
+        std::shared_ptr<this_t> self; //!< the connection
+    };
+
+    /** Launches async op and waits for its completion till timeout expires.
+     * If timeout expires the connection is broken and the socket is closed
+     * by reactor thread; the caller does not wait for it since the reactor
+     * may be busy. The op owns its buffers through the handler.
+     * @return count of bytes transferred by the op.
+     */
+    template <typename launch_t>
+    std::size_t wait(milliseconds_t timeout, const char *op, launch_t launch) {
+        if (broken) throw io::error_t(err::io_error, "connection is broken");
+        auto deadline = clock_t::now() + timeout;
+        std::unique_lock<std::mutex> guard(mutex);
+        done = false;
+        launch(handler_t{shared_from_this()});
+        if (!finished.wait_until(guard, deadline, [this] { return done;})) {
+            DBG(DBG3, "Connection timeouted: server=%s", addr.c_str());
+            broken = true;
+            auto self = shared_from_this();
+            asio::post(reactor->context(), [self] {
+                boost::system::error_code ignore;
+                self->socket.close(ignore);
+            });
+            throw io::error_t(err::timeout, std::string("can't ") + op
+                              + " due to timeout: dst=" + addr);
+        }
+        if (ec) throw io::error_t(err::io_error, ec.message());
+        return size;
+    }
+
+    /** Returns first bytes from input stream up to given count.
+     */
+    static std::string copy_n(asio::streambuf &stream, std::size_t count) {
+         auto ptr = static_cast<const char *>(stream.data().data());
+         std::string result(ptr, ptr + count);
+         stream.consume(count);
+         DBG(DBG1, "Read data from input stream: count=%zd, buffer=%s",
+                   count, log::escape(result).c_str());
+         return result;
+    }
+
+    std::string addr;                   //!< destination address
+    opts_t opts;                        //!< connection options
+    std::shared_ptr<reactor_t> reactor; //!< event loop
+    asio::ip::tcp::socket socket;       //!< i/o socket
+    asio::streambuf input;              //!< input buffer for incoming data
+    std::string output;                 //!< data written by reactor
+    std::mutex mutex;                   //!< guards op result
+    std::condition_variable finished;   //!< signals op completion
+    boost::system::error_code ec;       //!< result of last op
+    std::size_t size = 0;               //!< bytes transferred by last op
+    bool done = false;                  //!< true if last op is finished
+    bool broken = false;                //!< true if op has timed out
+};
+
+reactor_connection_t::reactor_connection_t(const std::string &addr,
+                                           opts_t opts)
+    : socket(std::make_shared<pimple_connection_t>(addr, opts))
+{
+    socket->connect();
+}
+
+void reactor_connection_t::write(const std::string &data) {
+    socket->write(data);
+}
+
+std::string reactor_connection_t::read(const std::string &delimiter) {
+    return socket->read_until(delimiter);
+}
+
+std::string reactor_connection_t::read(std::size_t bytes) {
+    return socket->read(bytes);
+}
+
+} // namespace tcp
+} // namespace io
+} // namespace mc
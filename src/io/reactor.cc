@@ -0,0 +1,113 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Event loop shared by async connections.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <thread>
+#include <vector>
+#include <optional>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+
+#include "error.h"
+#include "mcache/io/reactor.h"
+
+// shortcut
+namespace asio = boost::asio;
+
+namespace mc {
+namespace io {
+
+/** Pimple class for reactor.
+ */
+class reactor_t::pimple_reactor_t {
+public:
+    // shortcut
+    using work_t = asio::executor_work_guard<asio::io_context::executor_type>;
+
+    /** C'tor: creates own event loop run by threads.
+     */
+    explicit pimple_reactor_t(std::size_t count)
+        : own(std::make_shared<asio::io_context>()), context(*own),
+          work(asio::make_work_guard(context))
+    {
+        // the threads share the loop so it outlives the detached one
+        for (std::size_t i = 0; i < std::max(count, std::size_t(1)); ++i)
+            threads.emplace_back([own = own] { run(*own);});
+    }
+
+    /** C'tor: attaches to foreign event loop.
+     */
+    explicit pimple_reactor_t(asio::io_context &context)
+        : context(context)
+    {}
+
+    /** D'tor. The last reference to reactor can be dropped by its own
+     * handler (it captures the connection that holds the reactor); the
+     * thread can't join itself so it is detached and it destroys the loop
+     * once the handler returns.
+     */
+    ~pimple_reactor_t() {
+        if (!own) return;
+        work.reset();
+        context.stop();
+        for (auto &thread: threads) {
+            if (thread.get_id() == std::this_thread::get_id()) thread.detach();
+            else thread.join();
+        }
+    }
+
+    /** Runs event loop till it is stopped.
+     */
+    static void run(asio::io_context &context) {
+        for (;;) {
+            try {
+                context.run();
+                return;
+            } catch (const std::exception &e) {
+                LOG(ERR3, "Exception escaped from reactor handler: %s",
+                          e.what());
+            }
+        }
+    }
+
+    std::shared_ptr<asio::io_context> own; //!< own event loop
+    asio::io_context &context;             //!< event loop
+    std::optional<work_t> work;            //!< keeps own loop running
+    std::vector<std::thread> threads;      //!< threads of own loop
+};
+
+reactor_t::reactor_t(std::size_t threads)
+    : pimple(std::make_unique<pimple_reactor_t>(threads))
+{}
+
+reactor_t::reactor_t(asio::io_context &context)
+    : pimple(std::make_unique<pimple_reactor_t>(context))
+{}
+
+reactor_t::~reactor_t() {}
+
+asio::io_context &reactor_t::context() { return pimple->context;}
+
+std::shared_ptr<reactor_t> reactor_t::instance() {
+    static std::shared_ptr<reactor_t> reactor
+        = std::make_shared<reactor_t>(1);
+    return reactor;
+}
+
+} // namespace io
+} // namespace mc
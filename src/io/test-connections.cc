@@ -19,6 +19,7 @@
 
 #include <ctime>
 #include <cstdlib>
+#include <vector>
 #include <iostream>
 #include <algorithm>
 #include <iterator>
@@ -36,6 +37,17 @@ public:
     connection_t(const std::string &, const mc::io::opts_t &) {}
 };
 
+class multiplexed_connection_t {
+public:
+    multiplexed_connection_t(const std::string &, const mc::io::opts_t &)
+        : broken()
+    {}
+
+    bool is_broken() const { return broken;}
+
+    bool broken;
+};
+
 template <typename connections_t, typename output_iterator_t>
 void pick_n(connections_t &connections, output_iterator_t iout, std::size_t n) {
     for (; n != 0; ++iout, --n) *iout = connections.pick();
@@ -55,6 +67,8 @@ typedef mc::io::create_new_connection_pool_t<connection_t> cn_connections_t;
 typedef mc::io::single_connection_pool_t<connection_t> s_connections_t;
 typedef mc::io::bbt::caching_connection_pool_t<connection_t> tbb_connections_t;
 typedef mc::io::lock::caching_connection_pool_t<connection_t> l_connections_t;
+typedef mc::io::shared_connection_pool_t<multiplexed_connection_t>
+        m_connections_t;
 
 template <typename connections_t>
 bool connections_get() {
@@ -141,6 +155,34 @@ bool single_connection_multi_get() {
     return false;
 }
 
+bool multiplexed_connections_shared() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    try {
+        mc::io::opts_t opts;
+        opts.multiplexed_connections = 3;
+        m_connections_t connections("localhost:11211", opts);
+
+        // many callers hold connections at once but only 3 are created
+        std::vector<m_connections_t::connection_ptr_t> ptrs;
+        for (int i = 0; i < 30; ++i) ptrs.push_back(connections.pick());
+        if (connections.size() != 3) return false;
+        if (ptrs[0] != ptrs[3] || ptrs[0] == ptrs[1]) return false;
+
+        // broken connection is replaced by new one
+        ptrs[0]->broken = true;
+        auto replaced = connections.pick();
+        for (int i = 0; i < 2; ++i) connections.pick();
+        if (connections.pick() == ptrs[0]) return false;
+
+        connections.push_back(replaced);
+        connections.clear();
+        return !replaced && (connections.size() == 0);
+
+    } catch (const std::exception &e) { std::cerr << e.what() << std::endl;}
+    return false;
+}
+
 class Checker_t {
 public:
     Checker_t(): fails() {}
@@ -169,6 +211,7 @@ int main(int, char **) {
     check(test::connections_capacity<test::tbb_connections_t>());
     check(test::connections_capacity<test::l_connections_t>());
     check(test::single_connection_multi_get());
+    check(test::multiplexed_connections_shared());
     return check.fails;
 }
 
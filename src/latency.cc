@@ -0,0 +1,148 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Latency statistics of memcache servers.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include "mcache/latency.h"
+
+namespace mc {
+namespace {
+
+/// count of buckets per octave
+const double per_octave = 4;
+
+/** Returns index of sketch bucket for latency in microseconds.
+ */
+std::size_t bucket(double latency) {
+    double idx = std::floor(per_octave * std::log2(latency + 1));
+    return std::size_t(std::min(std::max(idx, 0.0),
+                                double(latency_t::buckets - 1)));
+}
+
+/** Returns latency in the middle of sketch bucket (geometric).
+ */
+double middle(std::size_t idx) {
+    return std::exp2((double(idx) + 0.5) / per_octave) - 1;
+}
+
+} // namespace
+
+latency_t::latency_t(): ewma(-1) {
+    for (auto &count: counts) count.store(0);
+}
+
+void latency_t::record(microseconds_t latency, double alpha) {
+    double sample = double(latency.count());
+    ++counts[bucket(sample)];
+
+    // the first sample initializes the average
+    double current = ewma.load();
+    double next;
+    do {
+        next = current < 0? sample: current + alpha * (sample - current);
+    } while (!ewma.compare_exchange_weak(current, next));
+}
+
+microseconds_t latency_t::average() const {
+    return microseconds_t(int64_t(std::max(ewma.load(), 0.0)));
+}
+
+microseconds_t latency_t::percentile(double share) const {
+    uint64_t total = samples();
+    if (!total) return microseconds_t(0);
+    double target = std::min(std::max(share, 0.0), 1.0) * double(total);
+    uint64_t seen = 0;
+    for (std::size_t idx = 0; idx < buckets; ++idx) {
+        seen += counts[idx].load();
+        if (seen && (double(seen) >= target))
+            return microseconds_t(int64_t(middle(idx)));
+    }
+    return microseconds_t(int64_t(middle(buckets - 1)));
+}
+
+uint64_t latency_t::samples() const {
+    uint64_t total = 0;
+    for (auto &count: counts) total += count.load();
+    return total;
+}
+
+void latency_t::decay() {
+    // the concurrent increments are not lost
+    for (auto &count: counts) count -= count.load() / 2;
+}
+
+void latency_t::reset() {
+    for (auto &count: counts) count.store(0);
+    ewma.store(-1);
+}
+
+namespace aux {
+
+std::vector<std::size_t>
+find_outliers(const std::vector<const latency_t *> &latencies,
+              const outlier_ejection_config_t &cfg,
+              microseconds_t &median)
+{
+    // the ejected servers count to the limit
+    std::size_t budget = std::size_t(cfg.max_ejected
+                                     * double(latencies.size()));
+    median = microseconds_t(0);
+    std::vector<std::pair<double, std::size_t>> judged;
+    for (std::size_t idx = 0; idx < latencies.size(); ++idx) {
+        if (!latencies[idx]) {
+            if (!budget--) return {};
+            continue;
+        }
+        if (latencies[idx]->samples() < cfg.min_samples) continue;
+        judged.emplace_back(double(latencies[idx]->average().count()), idx);
+    }
+    if (judged.size() < 3) return {};
+
+    // the median of moving averages
+    auto averages = judged;
+    auto half = averages.begin() + std::ptrdiff_t(averages.size() / 2);
+    std::nth_element(averages.begin(), half, averages.end());
+    double center = half->first;
+    if (!(averages.size() % 2)) {
+        center = (center + std::max_element(averages.begin(), half)->first)
+               / 2;
+    }
+    median = microseconds_t(int64_t(center));
+    double limit = std::max(cfg.factor * center,
+                            double(cfg.min_latency.count()));
+
+    // pick the slowest servers first
+    std::sort(judged.begin(), judged.end(),
+              [] (const auto &lhs, const auto &rhs) {
+                  return lhs.first > rhs.first;
+              });
+    std::vector<std::size_t> result;
+    for (auto &server: judged) {
+        if (!budget || (server.first < limit)) break;
+        auto sketch = latencies[server.second]->percentile(0.5);
+        if (double(sketch.count()) < limit) continue;
+        result.push_back(server.second);
+        --budget;
+    }
+    return result;
+}
+
+} // namespace aux
+} // namespace mc
@@ -0,0 +1,154 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Benchmark of libmcache pool implementations.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <unistd.h>
+
+#include <mcache/init.h>
+#include <mcache/hash.h>
+#include <mcache/pool/consistent-hashing.h>
+#include <mcache/pool/flat-consistent-hashing.h>
+#include <mcache/pool/jump.h>
+#include <mcache/pool/ketama.h>
+#include <mcache/pool/maglev.h>
+#include <mcache/pool/rendezvous.h>
+
+namespace {
+
+/** Prints one line of results.
+ */
+void report(const char *name, const char *op,
+            std::chrono::nanoseconds elapsed, std::size_t count)
+{
+    std::cout << std::setw(36) << std::left << name
+              << std::setw(10) << std::left << op
+              << std::setw(12) << std::right << std::fixed
+              << std::setprecision(1)
+              << double(elapsed.count()) / double(count) << " ns/op"
+              << std::endl;
+}
+
+/** Measures pool construction, choose() and choose() followed by failover to
+ * next servers.
+ */
+template <typename pool_t>
+void bench(const char *name,
+           const std::vector<std::string> &servers,
+           const std::vector<std::string> &keys)
+{
+    using clock_t = std::chrono::steady_clock;
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+
+    auto start = clock_t::now();
+    pool_t pool(servers);
+    report(name, "build", duration_cast<nanoseconds>(clock_t::now() - start),
+           1);
+
+    // the sum prevents the compiler from optimizing the lookup out
+    uint64_t sum = 0;
+    start = clock_t::now();
+    for (auto &key: keys) sum += *pool.choose(key);
+    report(name, "choose", duration_cast<nanoseconds>(clock_t::now() - start),
+           keys.size());
+
+    start = clock_t::now();
+    for (auto &key: keys) {
+        auto iidx = pool.choose(key);
+        for (int i = 0; i < 4; ++i, ++iidx) sum += *iidx;
+    }
+    report(name, "failover",
+           duration_cast<nanoseconds>(clock_t::now() - start), keys.size());
+    if (sum == 42) std::cout << std::endl;
+}
+
+/** Measures pool construction that writes ring snapshot and construction that
+ * maps it.
+ */
+template <typename pool_t>
+void bench_snapshot(const char *name,
+                    const std::vector<std::string> &servers)
+{
+    using clock_t = std::chrono::steady_clock;
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+
+    mc::consistent_hashing_pool_config_t cfg;
+    cfg.snapshot = "/tmp/bench-pool-snapshot-" + std::to_string(::getpid());
+    ::unlink(cfg.snapshot.c_str());
+    auto start = clock_t::now();
+    pool_t written(servers, cfg);
+    report(name, "save", duration_cast<nanoseconds>(clock_t::now() - start),
+           1);
+
+    start = clock_t::now();
+    pool_t mapped(servers, cfg);
+    report(name, "load", duration_cast<nanoseconds>(clock_t::now() - start),
+           1);
+    ::unlink(cfg.snapshot.c_str());
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    mc::init();
+
+    // params
+    std::size_t count = argc > 1? std::strtoul(argv[1], nullptr, 10): 60;
+    std::size_t lookups = argc > 2? std::strtoul(argv[2], nullptr, 10): 1000000;
+    if (!count || !lookups) {
+        std::cerr << "Usage: " << argv[0] << " [servers [lookups]]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // prepare servers and keys
+    std::vector<std::string> servers;
+    for (std::size_t i = 0; i < count; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < lookups; ++i)
+        keys.push_back("key-" + std::to_string(i * 7919));
+
+    // lookups of random keys
+    bench<mc::consistent_hashing_pool_t<mc::murmur3_t>>(
+            "consistent_hashing_pool_t", servers, keys);
+    bench<mc::flat_consistent_hashing_pool_t<mc::murmur3_t>>(
+            "flat_consistent_hashing_pool_t", servers, keys);
+    bench<mc::flat_consistent_hashing_pool_t<mc::xxh3_64_t>>(
+            "flat_consistent_hashing_pool_t/64", servers, keys);
+    bench<mc::ketama_pool_t>("ketama_pool_t", servers, keys);
+    bench<mc::jump_pool_t<mc::murmur3_t>>("jump_pool_t", servers, keys);
+    bench<mc::maglev_pool_t<mc::murmur3_t>>("maglev_pool_t", servers, keys);
+    bench<mc::rendezvous_pool_t<mc::murmur3_t>>(
+            "rendezvous_pool_t", servers, keys);
+
+    // cold start from ring snapshot
+    bench_snapshot<mc::flat_consistent_hashing_pool_t<mc::murmur3_t>>(
+            "flat_consistent_hashing_pool_t", servers);
+    bench_snapshot<mc::flat_consistent_hashing_pool_t<mc::xxh3_64_t>>(
+            "flat_consistent_hashing_pool_t/64", servers);
+    bench_snapshot<mc::ketama_pool_t>("ketama_pool_t", servers);
+    return EXIT_SUCCESS;
+}
@@ -17,10 +17,25 @@
  *                  First draft.
  */
 
+#include <cmath>
+#include <limits>
 #include <algorithm>
 #include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "error.h"
+#include "mcache/hash/xxhash.h"
 #include "mcache/pool/consistent-hashing.h"
+#include "mcache/pool/flat-consistent-hashing.h"
 
 namespace mc {
 namespace {
@@ -58,15 +73,325 @@ private:
     const std::vector<std::string> &states; //!< proxies states
 };
 
+/** Sums the part of hash space that belongs to each server. The ring node
+ * owns the keys with hashes from previous node (exclusive) to itself
+ * (inclusive); the first node owns also the keys behind the last node.
+ */
+template <typename hash_t>
+class share_t {
+public:
+    /** Adds ring node to the sums.
+     */
+    template <typename Node_t>
+    void operator()(const Node_t &node) {
+        if (node.second >= arcs.size()) {
+            arcs.resize(node.second + 1);
+            nodes.resize(node.second + 1);
+        }
+        if (!count++) {
+            first = node.second;
+            head = node.first;
+        } else {
+            arcs[node.second] += double(hash_t(node.first - last));
+        }
+        ++nodes[node.second];
+        last = node.first;
+    }
+
+    /** Dumps count of nodes and share of ring of each server to string.
+     */
+    void dump(const dump_t &dump, std::string &result) {
+        const double space
+            = std::ldexp(1.0, std::numeric_limits<hash_t>::digits);
+        // the arc of the only node is whole hash space
+        if (count) {
+            arcs[first] += count == 1? space: double(hash_t(head - last));
+        }
+        for (uint32_t idx = 0; idx < arcs.size(); ++idx) {
+            std::ostringstream os;
+            os << "server " << dump.desc(idx) << ": nodes=" << nodes[idx]
+               << ", share=" << std::fixed << std::setprecision(2)
+               << 100.0 * arcs[idx] / space << "%" << std::endl;
+            result.append(os.str());
+        }
+    }
+
+private:
+    std::vector<double> arcs;    //!< owned part of hash space per server
+    std::vector<uint32_t> nodes; //!< count of ring nodes per server
+    std::size_t count = 0;       //!< count of ring nodes
+    uint32_t first = 0;          //!< server of the first ring node
+    hash_t head = 0;             //!< hash of the first ring node
+    hash_t last = 0;             //!< hash of the previous ring node
+};
+
+/** Dumps flat ring and share of ring of each server to string.
+ */
+template <typename hash_t>
+std::string dump_flat(const hash_t *hashes,
+                      const uint32_t *servers,
+                      std::size_t size,
+                      const std::vector<std::string> &states)
+{
+    std::string result;
+    dump_t dump(states, result);
+    share_t<hash_t> share;
+    for (std::size_t i = 0; i < size; ++i) {
+        auto node = std::make_pair(hashes[i], servers[i]);
+        dump(node);
+        share(node);
+    }
+    share.dump(dump, result);
+    return result;
+}
+
+/** Header of ring snapshot file. It is followed by the arrays of ring: the
+ * hashes, the server indices and the rows of successors. The numbers are
+ * stored in native byte order, the snapshot is not meant to be portable.
+ */
+class snapshot_header_t {
+public:
+    char magic[8];      //!< the snapshot_magic
+    uint32_t version;   //!< the snapshot_version
+    uint32_t hash_size; //!< size of ring node hash in bytes
+    uint64_t checksum;  //!< checksum of addresses, config and hash function
+    uint64_t digest;    //!< checksum of arrays
+    uint64_t size;      //!< count of ring nodes
+    uint32_t depth;     //!< count of servers in row of successors
+    uint32_t reserved;  //!< zero
+};
+
+/// identifies ring snapshot files
+const char snapshot_magic[8] = {'M', 'C', 'R', 'I', 'N', 'G', '\0', '\0'};
+
+/// version of ring snapshot file format
+const uint32_t snapshot_version = 1;
+
+/** Returns checksum of ring arrays.
+ */
+uint64_t snapshot_digest(const void *hashes, uint32_t hash_size,
+                         const uint32_t *servers, const uint32_t *rows,
+                         std::size_t size, uint32_t depth)
+{
+    uint64_t digest = xxh3(hashes, size * hash_size);
+    digest = xxh3(servers, size * sizeof(uint32_t), digest);
+    return xxh3(rows, size * depth * sizeof(uint32_t), digest);
+}
+
+/** Writes whole buffer to file descriptor.
+ */
+bool write_all(int fd, const void *buf, std::size_t size) {
+    const char *data = static_cast<const char *>(buf);
+    while (size) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= std::size_t(written);
+    }
+    return true;
+}
+
 } // namespace
 
 std::string
 consistent_hashing_pool_base_t
 ::dump(const ring_t &ring, const std::vector<std::string> &states) const {
     std::string result;
-    std::for_each(ring.begin(), ring.end(), dump_t(states, result));
+    dump_t dump(states, result);
+    share_t<uint32_t> share;
+    for (auto &node: ring) {
+        dump(node);
+        share(node);
+    }
+    share.dump(dump, result);
     return result;
 }
 
-} // namespace mc
+std::string
+flat_consistent_hashing_pool_base_t
+::dump(const uint32_t *hashes,
+       const value_type *servers,
+       std::size_t size,
+       const std::vector<std::string> &states)
+{
+    return dump_flat(hashes, servers, size, states);
+}
+
+std::string
+flat_consistent_hashing_pool_base_t
+::dump(const uint64_t *hashes,
+       const value_type *servers,
+       std::size_t size,
+       const std::vector<std::string> &states)
+{
+    return dump_flat(hashes, servers, size, states);
+}
+
+uint32_t
+flat_consistent_hashing_pool_base_t
+::successors(const servers_t &servers, uint32_t depth, servers_t &result) {
+    // the row can't be longer than count of distinct servers
+    servers_t distinct(servers);
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()),
+                   distinct.end());
+    depth = std::min<uint32_t>(depth, uint32_t(distinct.size()));
+
+    // walk the ring from each node till the row is full
+    result.assign(servers.size() * depth, 0);
+    for (std::size_t inode = 0; inode < servers.size(); ++inode) {
+        auto row = result.begin() + inode * depth;
+        auto erow = row;
+        for (std::size_t i = inode; erow != row + depth; ++i) {
+            value_type server = servers[i % servers.size()];
+            if (std::find(row, erow, server) == erow) *erow++ = server;
+        }
+    }
+    return depth;
+}
+
+uint64_t
+flat_consistent_hashing_pool_base_t
+::checksum(const std::vector<std::string> &addresses,
+           const consistent_hashing_pool_config_t &cfg,
+           const std::string &hash_id)
+{
+    // the lengths keep the boundaries of strings
+    std::string data;
+    auto append = [&data] (const void *buf, std::size_t size) {
+        data.append(static_cast<const char *>(buf), size);
+    };
+    uint64_t count = addresses.size();
+    append(&count, sizeof(count));
+    for (auto &address: addresses) {
+        uint64_t length = address.size();
+        append(&length, sizeof(length));
+        data.append(address);
+    }
+    append(&cfg.virtual_nodes, sizeof(cfg.virtual_nodes));
+    append(&cfg.successors, sizeof(cfg.successors));
+    count = cfg.weights.size();
+    append(&count, sizeof(count));
+    append(cfg.weights.data(), cfg.weights.size() * sizeof(double));
+    data.append(hash_id);
+    return xxh3(data);
+}
+
+bool
+flat_consistent_hashing_pool_base_t
+::save(const std::string &path, uint64_t checksum, uint32_t hash_size,
+       const void *hashes, const value_type *servers, const value_type *rows,
+       std::size_t size, uint32_t depth)
+{
+    snapshot_header_t header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+    header.version = snapshot_version;
+    header.hash_size = hash_size;
+    header.checksum = checksum;
+    header.digest
+        = snapshot_digest(hashes, hash_size, servers, rows, size, depth);
+    header.size = size;
+    header.depth = depth;
 
+    // the concurrent writers make the same file so the last rename wins
+    std::string tmp = path + ".XXXXXX";
+    int fd = ::mkstemp(&tmp[0]);
+    if (fd < 0) {
+        LOG(WARN2, "Can't create ring snapshot: path=%s, error=%s",
+            tmp.c_str(), std::strerror(errno));
+        return false;
+    }
+    bool ok = ::fchmod(fd, 0644) == 0
+           && write_all(fd, &header, sizeof(header))
+           && write_all(fd, hashes, size * hash_size)
+           && write_all(fd, servers, size * sizeof(value_type))
+           && write_all(fd, rows, size * depth * sizeof(value_type));
+    int error = errno;
+    if (::close(fd) && ok) {
+        ok = false;
+        error = errno;
+    }
+    if (ok && std::rename(tmp.c_str(), path.c_str())) {
+        ok = false;
+        error = errno;
+    }
+    if (!ok) {
+        LOG(WARN2, "Can't write ring snapshot: path=%s, error=%s",
+            path.c_str(), std::strerror(error));
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    LOG(INFO3, "Ring snapshot written: path=%s, nodes=%zu",
+        path.c_str(), size);
+    return true;
+}
+
+flat_consistent_hashing_pool_base_t::snapshot_t
+flat_consistent_hashing_pool_base_t
+::load(const std::string &path, uint64_t checksum, uint32_t hash_size,
+       std::size_t servers)
+{
+    namespace bip = boost::interprocess;
+    auto reject = [&path] (const char *reason) {
+        LOG(WARN3, "Ring snapshot rejected: path=%s, reason=%s",
+            path.c_str(), reason);
+        return snapshot_t();
+    };
+
+    std::shared_ptr<bip::mapped_region> region;
+    try {
+        bip::file_mapping file(path.c_str(), bip::read_only);
+        region = std::make_shared<bip::mapped_region>(file, bip::read_only);
+    } catch (const bip::interprocess_exception &e) {
+        // missing snapshot is usual at the first start
+        DBG(DBG1, "Ring snapshot not mapped: path=%s, error=%s",
+            path.c_str(), e.what());
+        return snapshot_t();
+    }
+    const char *base = static_cast<const char *>(region->get_address());
+    std::size_t available = region->get_size();
+
+    // check that the file holds ring made of the same config
+    snapshot_header_t header;
+    if (available < sizeof(header)) return reject("truncated header");
+    std::memcpy(&header, base, sizeof(header));
+    available -= sizeof(header);
+    if (std::memcmp(header.magic, snapshot_magic, sizeof(header.magic))
+        || (header.version != snapshot_version)
+        || (header.hash_size != hash_size))
+        return reject("unknown format");
+    if (header.checksum != checksum) return reject("other ring");
+    uint64_t node = hash_size
+                  + sizeof(value_type) * (uint64_t(header.depth) + 1);
+    if (!header.size || (header.size > available / node)
+        || (header.size * node != available))
+        return reject("bad size");
+
+    // check that the arrays are not damaged
+    // the size fits since it has been checked against the mapped size
+    snapshot_t result;
+    result.size = header.size;
+    result.depth = header.depth;
+    result.hashes = base + sizeof(header);
+    result.servers = reinterpret_cast<const value_type *>(
+            base + sizeof(header) + result.size * hash_size);
+    result.rows = result.servers + result.size;
+    if (header.digest != snapshot_digest(result.hashes, hash_size,
+                                         result.servers, result.rows,
+                                         result.size, result.depth))
+        return reject("bad digest");
+
+    // the indices are used unchecked by the pool
+    std::size_t indices = result.size * (std::size_t(result.depth) + 1);
+    if (std::any_of(result.servers, result.servers + indices,
+                    [servers] (value_type idx) { return idx >= servers;}))
+        return reject("bad server index");
+    result.memory = std::move(region);
+    return result;
+}
+
+} // namespace mc
@@ -0,0 +1,81 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Consistent hashing pool compatible with libketama.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <cmath>
+#include <utility>
+#include <algorithm>
+
+#include "mcache/pool/ketama.h"
+
+namespace mc {
+
+flat_ring_t<uint32_t>
+ketama_pool_t::build(const std::vector<std::string> &addresses,
+                     const consistent_hashing_pool_config_t &cfg)
+{
+    // at least one address must be supplied
+    if (addresses.empty()) throw std::out_of_range(__PRETTY_FUNCTION__);
+    cfg.check(addresses.size());
+
+    // libketama computes the count of digests in floats so do we
+    float total = 0;
+    for (std::size_t idx = 0; idx < addresses.size(); ++idx)
+        total += cfg.weights.empty()? 1.0f: float(cfg.weights[idx]);
+
+    // create namespace ring nodes
+    std::vector<std::pair<uint32_t, value_type>> nodes;
+    for (std::size_t idx = 0; idx < addresses.size(); ++idx) {
+        float weight = cfg.weights.empty()? 1.0f: float(cfg.weights[idx]);
+        float pct = weight / total;
+        auto digests = static_cast<unsigned>(
+            std::floor(float(pct * 40.0 * float(addresses.size()))));
+        for (unsigned i = 0; i < digests; ++i) {
+            std::string point = addresses[idx] + "-" + std::to_string(i);
+            uint8_t digest[16];
+            md5(point.data(), point.size(), digest);
+            for (unsigned j = 0; j < 4; ++j) {
+                nodes.emplace_back(ketama_point(digest, j),
+                                   static_cast<value_type>(idx));
+            }
+        }
+    }
+    std::stable_sort(nodes.begin(), nodes.end(),
+                     [] (const auto &lhs, const auto &rhs) {
+                         return lhs.first < rhs.first;
+                     });
+
+    // split nodes to hashes and server indices
+    hashes_t hashes;
+    servers_t servers;
+    hashes.reserve(nodes.size());
+    servers.reserve(nodes.size());
+    for (auto &node: nodes) {
+        hashes.push_back(node.first);
+        servers.push_back(node.second);
+    }
+
+    // precompute distinct failover servers
+    servers_t rows;
+    uint32_t depth = 0;
+    if (cfg.successors) depth = successors(servers, cfg.successors, rows);
+    return flat_ring_t<uint32_t>(std::move(hashes), std::move(servers),
+                                 std::move(rows), depth);
+}
+
+} // namespace mc
@@ -0,0 +1,91 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Maglev hashing pool.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <sstream>
+#include <iomanip>
+
+#include "mcache/pool/maglev.h"
+
+namespace mc {
+
+bool maglev_pool_base_t::is_prime(uint32_t value) {
+    if (value < 2) return false;
+    for (uint64_t i = 2; i * i <= value; ++i)
+        if (value % i == 0) return false;
+    return true;
+}
+
+maglev_pool_base_t::table_t
+maglev_pool_base_t::populate(const std::vector<permutation_t> &permutations,
+                             uint32_t size)
+{
+    static const value_type empty = value_type(-1);
+    table_t table(size, empty);
+    std::vector<uint64_t> next(permutations.size());
+    for (uint32_t filled = 0;;) {
+        for (std::size_t i = 0; i < permutations.size(); ++i) {
+            // find first free slot in server preference
+            auto &permutation = permutations[i];
+            uint64_t slot;
+            do {
+                slot = (permutation.first + next[i]++ * permutation.second)
+                     % size;
+            } while (table[slot] != empty);
+            table[slot] = static_cast<value_type>(i);
+            if (++filled == size) return table;
+        }
+    }
+}
+
+maglev_pool_base_t::table_t
+maglev_pool_base_t::failovers(const table_t &table, uint32_t depth) {
+    table_t rows(table.size() * depth);
+    for (std::size_t slot = 0; slot < table.size(); ++slot) {
+        auto row = rows.begin() + slot * depth;
+        auto erow = row;
+        // each server owns some slots so the walk always finds depth servers
+        for (std::size_t i = slot; erow != row + depth; ++i) {
+            value_type server = table[i % table.size()];
+            if (std::find(row, erow, server) == erow) *erow++ = server;
+        }
+    }
+    return rows;
+}
+
+std::string
+maglev_pool_base_t::dump(const table_t &table,
+                         const std::vector<std::string> &states) const
+{
+    std::vector<std::size_t> slots;
+    for (auto server: table) {
+        if (server >= slots.size()) slots.resize(server + 1);
+        ++slots[server];
+    }
+    std::ostringstream os;
+    for (std::size_t idx = 0; idx < slots.size(); ++idx) {
+        os << "[" << idx << "] -> " << slots[idx] << " slots ("
+           << std::fixed << std::setprecision(2)
+           << 100.0 * double(slots[idx]) / double(table.size()) << "%)";
+        if (idx < states.size()) os << " {" << states[idx] << "}";
+        os << std::endl;
+    }
+    return os.str();
+}
+
+} // namespace mc
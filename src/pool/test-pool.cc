@@ -18,15 +18,23 @@
  */
 
 #include <ctime>
+#include <tuple>
 #include <cstdlib>
 #include <iostream>
 #include <algorithm>
 #include <cxxabi.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include <mcache/init.h>
 #include <mcache/error.h>
 #include <mcache/pool/consistent-hashing.h>
+#include <mcache/pool/flat-consistent-hashing.h>
 #include <mcache/pool/mod.h>
+#include <mcache/pool/jump.h>
+#include <mcache/pool/ketama.h>
+#include <mcache/pool/maglev.h>
+#include <mcache/pool/rendezvous.h>
 #include <mcache/hash.h>
 
 namespace test {
@@ -47,6 +55,15 @@ public:
 typedef mc::mod_pool_t<mc::murmur3_t> mod_pool_t;
 typedef mc::consistent_hashing_pool_t<mc::murmur3_t> consistent_hashing_pool_t;
 typedef mc::consistent_hashing_pool_t<fake_t> fake_consistent_hashing_pool_t;
+typedef mc::flat_consistent_hashing_pool_t<mc::murmur3_t>
+        flat_consistent_hashing_pool_t;
+typedef mc::jump_pool_t<mc::murmur3_t> jump_pool_t;
+typedef mc::rendezvous_pool_t<mc::murmur3_t> rendezvous_pool_t;
+typedef mc::maglev_pool_t<mc::murmur3_t> maglev_pool_t;
+typedef mc::flat_consistent_hashing_pool_t<fake_t>
+        fake_flat_consistent_hashing_pool_t;
+typedef mc::flat_consistent_hashing_pool_t<mc::xxh3_64_t>
+        flat_consistent_hashing_pool64_t;
 
 template <typename pool_t>
 bool throws_if_empty_addresses() {
@@ -70,6 +87,7 @@ bool mod_pool_iteration() {
     return pool.choose("b") != pool.end() && ++pool.choose("b") == pool.end();
 }
 
+template <typename pool_t>
 bool consistent_hashing_pool_iteration() {
     std::cout << __PRETTY_FUNCTION__ << ": ";
     mc::consistent_hashing_pool_config_t cfg;
@@ -78,7 +96,7 @@ bool consistent_hashing_pool_iteration() {
     servers.push_back("server1:11211");
     servers.push_back("server2:11211");
     servers.push_back("server3:11211");
-    consistent_hashing_pool_t pool(servers, cfg);
+    pool_t pool(servers, cfg);
     // checks if we go through all ring nodes then pool throws
     std::size_t cnt = 0;
     std::size_t cnt1 = 0;
@@ -96,6 +114,7 @@ bool consistent_hashing_pool_iteration() {
     return (cnt == 120) && (cnt1 == 40) && (cnt2 == 40) && (cnt3 == 40);
 }
 
+template <typename pool_t>
 bool consistent_hashing_pool_distribution() {
     std::cout << __PRETTY_FUNCTION__ << ": ";
     mc::consistent_hashing_pool_config_t cfg;
@@ -104,7 +123,7 @@ bool consistent_hashing_pool_distribution() {
     servers.push_back("server1:11211");
     servers.push_back("server2:11211");
     servers.push_back("server3:11211");
-    fake_consistent_hashing_pool_t pool(servers, cfg);
+    pool_t pool(servers, cfg);
     // checks whether key distribution with fake hash functor is like:
     // [1000] -> 0
     // [2000] -> 0
@@ -115,7 +134,7 @@ bool consistent_hashing_pool_distribution() {
     // [100000] -> 2
     // [200000] -> 2
     // [300000] -> 2
-    fake_consistent_hashing_pool_t::const_iterator iidx = pool.choose("a");
+    typename pool_t::const_iterator iidx = pool.choose("a");
     if ((*iidx != 0) || (*++iidx != 0) || (*++iidx != 0)) return false;
     iidx = pool.choose("b");
     if ((*iidx != 1) || (*++iidx != 1) || (*++iidx != 1)) return false;
@@ -124,6 +143,484 @@ bool consistent_hashing_pool_distribution() {
     return (*++iidx == 0) && (*pool.choose("server1:11211") == 0);
 }
 
+bool flat_consistent_hashing_pool_same_ring() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers;
+    for (int i = 0; i < 60; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    consistent_hashing_pool_t pool(servers);
+    flat_consistent_hashing_pool_t flat(servers);
+    // checks whether both pools choose the same servers in the same order
+    for (int i = 0; i < 10000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        auto iidx = pool.choose(key);
+        auto fidx = flat.choose(key);
+        for (int j = 0; j < 5; ++j, ++iidx, ++fidx)
+            if (*iidx != *fidx) return false;
+    }
+    return std::equal(pool.begin(), pool.end(), flat.begin(), flat.end())
+        && (pool.dump() == flat.dump());
+}
+
+template <typename pool_t>
+bool consistent_hashing_pool_weights() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    mc::consistent_hashing_pool_config_t cfg;
+    cfg.weights = {1, 1, 2};
+    std::vector<std::string> servers;
+    servers.push_back("server1:11211");
+    servers.push_back("server2:11211");
+    servers.push_back("server3:11211");
+    pool_t pool(servers, cfg);
+    // checks whether count of virtual nodes is scaled by weight (iterator
+    // walks the ring twice)
+    std::vector<std::size_t> nodes(servers.size());
+    for (auto &server: pool) ++nodes[server];
+    if ((nodes[0] != 400) || (nodes[1] != 400) || (nodes[2] != 800))
+        return false;
+    // checks whether heavy server gets about half of keys
+    std::vector<std::size_t> hits(servers.size());
+    for (int i = 0; i < 20000; ++i)
+        ++hits[*pool.choose("key" + std::to_string(i))];
+    if ((hits[2] < 9000) || (hits[2] > 11000)) return false;
+    // checks whether dump reports share of each server
+    std::string dump = pool.dump();
+    if (dump.find("server 2: nodes=400, share=") == std::string::npos)
+        return false;
+    // checks whether invalid weights are refused
+    cfg.weights = {1, 2};
+    try {
+        pool_t invalid(servers, cfg);
+        return false;
+    } catch (const std::invalid_argument &) {}
+    return true;
+}
+
+bool consistent_hashing_pool_share() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    mc::consistent_hashing_pool_config_t cfg;
+    cfg.virtual_nodes = 1;
+    std::vector<std::string> servers;
+    servers.push_back("server1:11211");
+    servers.push_back("server2:11211");
+    fake_consistent_hashing_pool_t pool(servers, cfg);
+    // the ring nodes are [1000] -> 0 and [10000] -> 1
+    return pool.dump() == "[1000] -> 0\n"
+                          "[10000] -> 1\n"
+                          "server 0: nodes=1, share=100.00%\n"
+                          "server 1: nodes=1, share=0.00%\n";
+}
+
+class fake64_t {
+public:
+    uint64_t operator()(const std::string &str, uint64_t seed = 0) const {
+        if (str == "server1:11211") return seed + (uint64_t(1) << 40);
+        if (str == "server2:11211") return seed + (uint64_t(1) << 62);
+        return 0;
+    }
+};
+
+bool consistent_hashing_pool64_share() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    mc::consistent_hashing_pool_config_t cfg;
+    cfg.virtual_nodes = 1;
+    std::vector<std::string> servers;
+    servers.push_back("server1:11211");
+    servers.push_back("server2:11211");
+    mc::flat_consistent_hashing_pool_t<fake64_t> pool(servers, cfg);
+    // the ring nodes are [2^40] -> 0 and [2^62] -> 1 in 2^64 space
+    return pool.dump() == "[1099511627776] -> 0\n"
+                          "[4611686018427387904] -> 1\n"
+                          "server 0: nodes=1, share=75.00%\n"
+                          "server 1: nodes=1, share=25.00%\n";
+}
+
+bool consistent_hashing_pool64_collisions() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers;
+    for (int i = 0; i < 2000; ++i)
+        servers.push_back("10.0." + std::to_string(i / 256) + "."
+                          + std::to_string(i % 256) + ":11211");
+    // 400k ring nodes collide in 32bit hash space but not in 64bit one (the
+    // iterator walks the ring twice)
+    flat_consistent_hashing_pool_t pool(servers);
+    flat_consistent_hashing_pool64_t pool64(servers);
+    return (std::distance(pool.begin(), pool.end()) < 2 * 400000)
+        && (std::distance(pool64.begin(), pool64.end()) == 2 * 400000);
+}
+
+template <typename pool_t>
+bool consistent_hashing_pool_successors() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers;
+    for (int i = 0; i < 10; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    pool_t ring(servers);
+    mc::consistent_hashing_pool_config_t cfg;
+    cfg.successors = 4;
+    pool_t pool(servers, cfg);
+    // checks whether failover visits 4 distinct servers in the ring order
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        std::vector<uint32_t> expected;
+        for (auto iidx = ring.choose(key); expected.size() < 4; ++iidx)
+            if (std::find(expected.begin(), expected.end(), *iidx)
+                == expected.end()) expected.push_back(*iidx);
+        std::vector<uint32_t> visited(pool.choose(key), pool.end());
+        if (visited != expected) return false;
+    }
+    // checks whether the row is limited by count of servers
+    cfg.successors = 20;
+    pool_t small({"server1:11211", "server2:11211"}, cfg);
+    return std::distance(small.choose("key"), small.end()) == 2;
+}
+
+bool consistent_hashing_pool_rejects_successors() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    mc::consistent_hashing_pool_config_t cfg;
+    cfg.successors = 2;
+    try {
+        consistent_hashing_pool_t pool({"server1:11211"}, cfg);
+        return false;
+    } catch (const std::invalid_argument &) {}
+    return true;
+}
+
+/** Returns inode of file or 0 if it does not exist (the rewritten snapshot
+ * gets new inode since it is renamed over the old one).
+ */
+ino_t inode(const std::string &path) {
+    struct stat info;
+    return ::stat(path.c_str(), &info)? 0: info.st_ino;
+}
+
+template <typename pool_t>
+bool consistent_hashing_pool_snapshot() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers;
+    for (int i = 0; i < 10; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    mc::consistent_hashing_pool_config_t cfg;
+    cfg.successors = 2;
+    pool_t built(servers, cfg);
+    cfg.snapshot = "/tmp/test-pool-snapshot-" + std::to_string(::getpid());
+    ::unlink(cfg.snapshot.c_str());
+    // checks whether the first pool writes snapshot and the second maps it
+    pool_t first(servers, cfg);
+    ino_t written = inode(cfg.snapshot);
+    pool_t second(servers, cfg);
+    bool ok = written && (inode(cfg.snapshot) == written)
+           && (second.dump() == built.dump())
+           && std::equal(second.choose("key"), second.end(),
+                         built.choose("key"), built.end());
+    // checks whether damaged snapshot is rebuilt
+    {
+        FILE *file = std::fopen(cfg.snapshot.c_str(), "r+b");
+        std::fseek(file, -1, SEEK_END);
+        std::fputc(0x55, file);
+        std::fclose(file);
+        pool_t damaged(servers, cfg);
+        ok = ok && (inode(cfg.snapshot) != written)
+                && (damaged.dump() == built.dump());
+    }
+    // checks whether truncated snapshot is rebuilt
+    {
+        written = inode(cfg.snapshot);
+        ok = ok && !::truncate(cfg.snapshot.c_str(), 10);
+        pool_t truncated(servers, cfg);
+        ok = ok && (inode(cfg.snapshot) != written)
+                && (truncated.dump() == built.dump());
+    }
+    // checks whether snapshot of other config is not used
+    {
+        written = inode(cfg.snapshot);
+        cfg.successors = 3;
+        pool_t other(servers, cfg);
+        ok = ok && (inode(cfg.snapshot) != written)
+                && (std::distance(other.choose("key"), other.end()) == 3);
+    }
+    ::unlink(cfg.snapshot.c_str());
+    // checks whether unwritable snapshot does not break the pool
+    cfg.snapshot = "/nonexistent/test-pool-snapshot";
+    pool_t unwritable(servers, cfg);
+    return ok && (std::distance(unwritable.choose("key"),
+                                unwritable.end()) == 3);
+}
+
+bool md5_digest() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    // RFC 1321 test vectors
+    auto hex = [] (const std::string &data) {
+        uint8_t digest[16];
+        mc::md5(data.data(), data.size(), digest);
+        std::string result;
+        for (auto byte: digest) {
+            result.push_back("0123456789abcdef"[byte >> 4]);
+            result.push_back("0123456789abcdef"[byte & 0xf]);
+        }
+        return result;
+    };
+    return (hex("") == "d41d8cd98f00b204e9800998ecf8427e")
+        && (hex("abc") == "900150983cd24fb0d6963f7d28e17f72")
+        && (hex("1234567890123456789012345678901234567890"
+                "1234567890123456789012345678901234567890")
+            == "57edf4a22be3c955ac49da2e2107b67a")
+        && (mc::ketama_t()("foo") == 3675831724u);
+}
+
+bool xxh3_vectors() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    // values computed by reference XXH3_64bits_withSeed() for all code paths
+    std::string data;
+    for (uint32_t i = 0; i < 250; ++i) data.push_back(char(i * 7 + 3));
+    std::vector<std::tuple<std::size_t, uint64_t, uint64_t>> vectors = {
+        {0, 0x2d06800538d394c2ULL, 0xb029411ff43d84d2ULL},
+        {1, 0x13e608bc156defedULL, 0xd0c83c4bdeed078bULL},
+        {3, 0xa9088dda485b481cULL, 0x3a6eb7a191052c81ULL},
+        {4, 0x6d9253b16c8b1ed3ULL, 0x5d8ddb4735733babULL},
+        {8, 0x60539db630471163ULL, 0x53a895ca319fab31ULL},
+        {9, 0xfeff668361d723a8ULL, 0x43f019f90f24f866ULL},
+        {16, 0xb8c859b0f030b585ULL, 0x6b1b54f65d114c69ULL},
+        {17, 0x714a04408e79b80fULL, 0x148ada809b3845ddULL},
+        {64, 0x287eb1fa9e4be2c1ULL, 0x2b5ea8e567ef1236ULL},
+        {128, 0x67425a03650261bfULL, 0xeef663431a9bf01dULL},
+        {129, 0xc664bf3311c6abc4ULL, 0x4df9521149f6f8c5ULL},
+        {240, 0x64556dc6b462a6cfULL, 0x722964f8a7f16de3ULL},
+        {241, 0x8beadd3a8874fe17ULL, 0x59fdc74e63a7aee7ULL},
+        {250, 0x3b94ffd8f5d5621bULL, 0x4c166f66cc4151cfULL},
+    };
+    for (auto &vector: vectors) {
+        if (mc::xxh3(data.data(), std::get<0>(vector)) != std::get<1>(vector))
+            return false;
+        if (mc::xxh3(data.data(), std::get<0>(vector), 42)
+            != std::get<2>(vector)) return false;
+    }
+    return mc::xxh3("abc") == 0x78af5f94892f3950ULL;
+}
+
+bool crc32c_vectors() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    // RFC 3720 (iSCSI) test vectors
+    std::string zeros(32, '\0'), ones(32, '\xff'), ascending;
+    for (int i = 0; i < 32; ++i) ascending.push_back(char(i));
+    if (mc::crc32c("123456789") != 0xe3069283) return false;
+    if (mc::crc32c(zeros) != 0x8a9136aa) return false;
+    if (mc::crc32c(ones) != 0x62a8ab43) return false;
+    if (mc::crc32c(ascending) != 0x46dd794e) return false;
+    // checks whether seed continues the computation
+    std::string data = "0123456789abcdefghijklmnopqrstuvwxyz";
+    for (std::size_t i = 0; i <= data.size(); ++i) {
+        uint32_t head = mc::crc32c(data.data(), i);
+        if (mc::crc32c(data.data() + i, data.size() - i, head)
+            != mc::crc32c(data)) return false;
+    }
+    return true;
+}
+
+bool ketama_pool_placement() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers = {"10.0.0.1:11211", "10.0.0.2:11211",
+                                        "10.0.0.3:11211", "10.0.0.4:11211"};
+    std::vector<std::string> keys = {"foo", "bar", "baz", "user:1", "user:2",
+                                     "session:42", "a", "b"};
+    // placement of keys computed by reference ketama implementation
+    mc::ketama_pool_t pool(servers);
+    std::vector<uint32_t> expected = {2, 0, 3, 3, 2, 1, 2, 2};
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        if (*pool.choose(keys[i]) != expected[i]) return false;
+    if (std::distance(pool.begin(), pool.end()) != 2 * 640) return false;
+    // dtto for weighted servers
+    mc::consistent_hashing_pool_config_t cfg;
+    cfg.weights = {1, 1, 1, 3};
+    mc::ketama_pool_t weighted(servers, cfg);
+    expected = {3, 0, 3, 3, 3, 1, 3, 3};
+    for (std::size_t i = 0; i < keys.size(); ++i)
+        if (*weighted.choose(keys[i]) != expected[i]) return false;
+    return std::distance(weighted.begin(), weighted.end()) == 2 * 632;
+}
+
+bool jump_pool_iteration() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers;
+    for (int i = 0; i < 12; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    jump_pool_t pool(servers);
+    // checks whether failover walk visits every server exactly once
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        std::vector<int> visited(servers.size());
+        for (auto iidx = pool.choose(key); iidx != pool.end(); ++iidx)
+            ++visited[*iidx];
+        if (std::count(visited.begin(), visited.end(), 1) != 12) return false;
+    }
+    // checks whether walk is deterministic and it differs for keys
+    std::size_t differs = 0;
+    for (int i = 0; i < 1000; ++i) {
+        auto first = pool.choose("key" + std::to_string(i));
+        auto again = pool.choose("key" + std::to_string(i));
+        if (!std::equal(first, pool.end(), again, pool.end())) return false;
+        auto other = pool.choose("other" + std::to_string(i));
+        if (*first == *other && *++first != *++other) ++differs;
+    }
+    return differs > 0;
+}
+
+bool jump_pool_append_server() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers;
+    for (int i = 0; i < 9; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    jump_pool_t pool(servers);
+    servers.push_back("server9:11211");
+    jump_pool_t bigger(servers);
+    // checks whether keys move only to appended server (about 1/10 of them)
+    std::size_t moved = 0;
+    for (int i = 0; i < 10000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        if (*pool.choose(key) == *bigger.choose(key)) continue;
+        if (*bigger.choose(key) != 9) return false;
+        ++moved;
+    }
+    return (moved > 800) && (moved < 1200);
+}
+
+bool rendezvous_pool_ranking() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers;
+    for (int i = 0; i < 12; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    rendezvous_pool_t pool(servers);
+    // checks whether ranking visits every server exactly once
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        std::vector<int> visited(servers.size());
+        for (auto iidx = pool.choose(key); iidx != pool.end(); ++iidx)
+            ++visited[*iidx];
+        if (std::count(visited.begin(), visited.end(), 1) != 12) return false;
+    }
+    // checks whether ranking is deterministic and the best server is the
+    // one that remains best when the others are removed
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        auto first = pool.choose(key);
+        auto second = std::next(first);
+        if (!std::equal(first, pool.end(), pool.choose(key), pool.end()))
+            return false;
+        std::vector<std::string> pair = {servers[*first], servers[*second]};
+        if (*rendezvous_pool_t(pair).choose(key) != 0) return false;
+    }
+    return std::distance(pool.begin(), pool.end()) == 12;
+}
+
+bool rendezvous_pool_remove_server() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers;
+    for (int i = 0; i < 10; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    rendezvous_pool_t pool(servers);
+    servers.erase(servers.begin() + 3);
+    rendezvous_pool_t smaller(servers);
+    // checks whether only keys of removed server move and they move to their
+    // second best server
+    for (int i = 0; i < 10000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        auto iidx = pool.choose(key);
+        if (*iidx == 3) ++iidx;
+        std::size_t expected = *iidx > 3? *iidx - 1: *iidx;
+        if (*smaller.choose(key) != expected) return false;
+    }
+    return true;
+}
+
+bool rendezvous_pool_weights() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers;
+    for (int i = 0; i < 4; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    rendezvous_pool_t pool(servers, mc::rendezvous_pool_config_t({1, 1, 1, 5}));
+    // checks whether the server with weight 5 gets 5/8 of keys
+    std::vector<std::size_t> hits(servers.size());
+    for (int i = 0; i < 40000; ++i)
+        ++hits[*pool.choose("key" + std::to_string(i))];
+    for (int i = 0; i < 3; ++i)
+        if ((hits[i] < 4500) || (hits[i] > 5500)) return false;
+    if ((hits[3] < 23500) || (hits[3] > 26500)) return false;
+    // checks whether invalid weights are refused
+    try {
+        rendezvous_pool_t(servers, mc::rendezvous_pool_config_t({1, 2}));
+        return false;
+    } catch (const std::invalid_argument &) {}
+    try {
+        rendezvous_pool_t(servers, mc::rendezvous_pool_config_t({1, 1, 0, 1}));
+        return false;
+    } catch (const std::invalid_argument &) {}
+    return true;
+}
+
+bool maglev_pool_table() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers;
+    for (int i = 0; i < 10; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    maglev_pool_t pool(servers);
+    // checks whether each server owns about 1/10 of lookup table
+    std::vector<std::size_t> slots(servers.size());
+    for (auto &server: pool) ++slots[server];
+    for (auto count: slots) if ((count < 6500) || (count > 6600)) return false;
+    // checks whether failover row holds 4 distinct servers
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        std::vector<int> visited(servers.size());
+        std::size_t count = 0;
+        for (auto iidx = pool.choose(key); iidx != pool.end(); ++iidx, ++count)
+            ++visited[*iidx];
+        if (std::count(visited.begin(), visited.end(), 1) != 4) return false;
+        if (count != 4) return false;
+    }
+    std::string dump = pool.dump();
+    return std::count(dump.begin(), dump.end(), '\n') == 10;
+}
+
+bool maglev_pool_remove_server() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers;
+    for (int i = 0; i < 10; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    maglev_pool_t pool(servers);
+    servers.erase(servers.begin() + 3);
+    maglev_pool_t smaller(servers);
+    // checks whether keys of removed server and only a few others move
+    std::size_t moved = 0;
+    for (int i = 0; i < 10000; ++i) {
+        std::string key = "key" + std::to_string(i);
+        std::size_t idx = *pool.choose(key);
+        if (idx == 3) continue;
+        if (*smaller.choose(key) != (idx > 3? idx - 1: idx)) ++moved;
+    }
+    return moved < 500;
+}
+
+bool maglev_pool_invalid_table_size() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    std::vector<std::string> servers = {"server1:11211", "server2:11211",
+                                        "server3:11211"};
+    mc::maglev_pool_config_t cfg;
+    cfg.table_size = 65536;
+    try {
+        maglev_pool_t pool(servers, cfg);
+        return false;
+    } catch (const std::invalid_argument &) {}
+    cfg.table_size = 2;
+    try {
+        maglev_pool_t pool(servers, cfg);
+        return false;
+    } catch (const std::invalid_argument &) {}
+    // checks whether failover row is limited by count of servers
+    cfg.table_size = 7;
+    maglev_pool_t pool(servers, cfg);
+    return std::distance(pool.choose("a"), pool.end()) == 3;
+}
+
 class Checker_t {
 public:
     Checker_t(): fails() {}
@@ -147,8 +644,55 @@ int main(int, char **) {
     check(test::throws_if_empty_addresses<test::consistent_hashing_pool_t>());
     check(test::throws_if_empty_addresses<test::mod_pool_t>());
     check(test::mod_pool_iteration());
-    check(test::consistent_hashing_pool_iteration());
-    check(test::consistent_hashing_pool_distribution());
+    check(test::throws_if_empty_addresses<
+                test::flat_consistent_hashing_pool_t>());
+    check(test::consistent_hashing_pool_iteration<
+                test::consistent_hashing_pool_t>());
+    check(test::consistent_hashing_pool_iteration<
+                test::flat_consistent_hashing_pool_t>());
+    check(test::consistent_hashing_pool_distribution<
+                test::fake_consistent_hashing_pool_t>());
+    check(test::consistent_hashing_pool_distribution<
+                test::fake_flat_consistent_hashing_pool_t>());
+    check(test::flat_consistent_hashing_pool_same_ring());
+    check(test::consistent_hashing_pool_weights<
+                test::consistent_hashing_pool_t>());
+    check(test::consistent_hashing_pool_weights<
+                test::flat_consistent_hashing_pool_t>());
+    check(test::consistent_hashing_pool_share());
+    check(test::consistent_hashing_pool_successors<
+                test::flat_consistent_hashing_pool_t>());
+    check(test::consistent_hashing_pool_successors<mc::ketama_pool_t>());
+    check(test::consistent_hashing_pool_rejects_successors());
+    check(test::consistent_hashing_pool_iteration<
+                test::flat_consistent_hashing_pool64_t>());
+    check(test::consistent_hashing_pool_weights<
+                test::flat_consistent_hashing_pool64_t>());
+    check(test::consistent_hashing_pool_successors<
+                test::flat_consistent_hashing_pool64_t>());
+    check(test::consistent_hashing_pool64_share());
+    check(test::consistent_hashing_pool64_collisions());
+    check(test::consistent_hashing_pool_snapshot<
+                test::flat_consistent_hashing_pool_t>());
+    check(test::consistent_hashing_pool_snapshot<
+                test::flat_consistent_hashing_pool64_t>());
+    check(test::consistent_hashing_pool_snapshot<mc::ketama_pool_t>());
+    check(test::md5_digest());
+    check(test::xxh3_vectors());
+    check(test::crc32c_vectors());
+    check(test::throws_if_empty_addresses<mc::ketama_pool_t>());
+    check(test::ketama_pool_placement());
+    check(test::throws_if_empty_addresses<test::jump_pool_t>());
+    check(test::jump_pool_iteration());
+    check(test::jump_pool_append_server());
+    check(test::throws_if_empty_addresses<test::rendezvous_pool_t>());
+    check(test::rendezvous_pool_ranking());
+    check(test::rendezvous_pool_remove_server());
+    check(test::rendezvous_pool_weights());
+    check(test::throws_if_empty_addresses<test::maglev_pool_t>());
+    check(test::maglev_pool_table());
+    check(test::maglev_pool_remove_server());
+    check(test::maglev_pool_invalid_table_size());
     return check.fails;
 }
 
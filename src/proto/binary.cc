@@ -70,7 +70,10 @@ public:
 
     /** C'tor.
      */
-    header_t(uint16_t key_len, uint32_t body_len = 0, uint8_t extras_len = 0)
+    header_t(uint16_t key_len,
+             uint32_t body_len = 0,
+             uint8_t extras_len = 0,
+             uint32_t opaque = 0)
         : magic(request_magic),
           opcode(0x00),
           key_len(key_len),
@@ -78,7 +81,7 @@ public:
           data_type(0x00),
           reserved(0x00),
           body_len(body_len),
-          opaque(0x00),
+          opaque(opaque),
           cas(0x00)
     {}
 
@@ -150,6 +153,10 @@ void init() {
     initialize_map();
 }
 
+uint32_t command_t::response_opaque(const std::string &header) {
+    return header_t(header).opaque;
+}
+
 retrieve_command_t::response_t
 retrieve_command_t::deserialize_header(const std::string &header) const {
     // reject empty response
@@ -176,7 +183,7 @@ retrieve_command_t::deserialize_header(const std::string &header) const {
 
 std::string retrieve_command_t::serialize(uint8_t code) const {
     aux::check_key(key);
-    header_t hdr(key_len, body_len, extras_len);
+    header_t hdr(key_len, body_len, extras_len, opaque);
     hdr.opcode = code;
     hdr.prepare_serialization();
     std::string result(reinterpret_cast<char *>(&hdr), sizeof(hdr));
@@ -218,7 +225,7 @@ template <>
 std::string storage_command_t<true>::serialize(uint8_t code) const {
     // prepare request
     aux::check_key(key);
-    header_t hdr(key_len, body_len, extras_len);
+    header_t hdr(key_len, body_len, extras_len, opaque);
     hdr.opcode = code;
     if (opts.cas) hdr.cas = opts.cas;
     hdr.prepare_serialization();
@@ -242,7 +249,7 @@ std::string storage_command_t<true>::serialize(uint8_t code) const {
 template <>
 std::string storage_command_t<false>::serialize(uint8_t code) const {
     aux::check_key(key);
-    header_t hdr(key_len, body_len, extras_len);
+    header_t hdr(key_len, body_len, extras_len, opaque);
     hdr.opcode = code;
     if (opts.cas) hdr.cas = opts.cas;
     hdr.prepare_serialization();
@@ -277,7 +284,7 @@ incr_decr_command_t::deserialize_header(const std::string &header) const {
 std::string incr_decr_command_t::serialize(uint8_t code) const {
     // prepare request
     aux::check_key(key);
-    header_t hdr(key_len, body_len, extras_len);
+    header_t hdr(key_len, body_len, extras_len, opaque);
     hdr.opcode = code;
     hdr.prepare_serialization();
     std::string result(reinterpret_cast<char *>(&hdr), sizeof(hdr));
@@ -321,9 +328,13 @@ delete_command_t::deserialize_header(const std::string &header) const {
 }
 
 std::string delete_command_t::serialize() const {
+    return serialize(api::delete_code);
+}
+
+std::string delete_command_t::serialize(uint8_t code) const {
     aux::check_key(key);
-    header_t hdr(key_len, body_len, extras_len);
-    hdr.opcode = api::delete_code;
+    header_t hdr(key_len, body_len, extras_len, opaque);
+    hdr.opcode = code;
     hdr.prepare_serialization();
     std::string result(reinterpret_cast<char *>(&hdr), sizeof(hdr));
     result.append(key);
@@ -352,7 +363,7 @@ touch_command_t::deserialize_header(const std::string &header) const {
 std::string touch_command_t::serialize(uint8_t code) const {
     // prepare request
     aux::check_key(key);
-    header_t hdr(key_len, body_len, extras_len);
+    header_t hdr(key_len, body_len, extras_len, opaque);
     hdr.opcode = code;
     hdr.prepare_serialization();
     std::string result(reinterpret_cast<char *>(&hdr), sizeof(hdr));
@@ -383,7 +394,7 @@ flush_all_command_t::deserialize_header(const std::string &header) const {
 
 std::string flush_all_command_t::serialize() const {
     // prepare request
-    header_t hdr(key_len, body_len, extras_len);
+    header_t hdr(key_len, body_len, extras_len, opaque);
     hdr.opcode = api::flush_code;
     hdr.prepare_serialization();
     std::string result(reinterpret_cast<char *>(&hdr), sizeof(hdr));
@@ -396,6 +407,81 @@ std::string flush_all_command_t::serialize() const {
     return result;
 }
 
+version_command_t::response_t
+version_command_t::deserialize_header(const std::string &header) const {
+    // reject empty response
+    if (header.empty()) return response_t(resp::empty, "empty response");
+
+    // parse header && check protocol magic
+    header_t hdr(header);
+    if (hdr.magic != header_t::response_magic)
+        return response_t(resp::unrecognized, "bad magic in response");
+
+    // check status (the body holds the version or the error)
+    if (!hdr.status) return response_t(resp::ok, hdr.body_len);
+    return response_t(translate_status_to_response(hdr.status), hdr.body_len);
+}
+
+std::string version_command_t::serialize() const {
+    header_t hdr(key_len, body_len, extras_len, opaque);
+    hdr.opcode = api::version_code;
+    hdr.prepare_serialization();
+    return std::string(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+}
+
+template <typename command_type>
+typename multi_command_t<command_type>::item_t
+multi_command_t<command_type>
+::deserialize_header(const std::string &header, std::size_t) const {
+    typedef typename item_t::parent_t parent_t;
+
+    // reject empty response
+    if (header.empty())
+        return item_t(std::string(), parent_t(resp::empty, "empty response"),
+                      true);
+
+    // parse header && check protocol magic
+    header_t hdr(header);
+    if (hdr.magic != header_t::response_magic)
+        return item_t(std::string(),
+                      parent_t(resp::unrecognized, "bad magic in response"),
+                      true);
+
+    // the noop response closes the batch
+    if (hdr.opcode == api::noop_code)
+        return item_t(std::string(), parent_t(resp::ok), true);
+
+    // find command that the response belongs to
+    uint32_t index = hdr.opaque - opaque;
+    if (index >= commands.size())
+        return item_t(std::string(),
+                      parent_t(resp::invalid, "bad opaque in response"),
+                      true);
+    const item_command_t &command = commands[index];
+
+    // if response is broken we can't continue reading the batch
+    parent_t response = command.deserialize_header(header);
+    return item_t(command.key, response, response.code() >= resp::empty);
+}
+
+template <typename command_type>
+std::string multi_command_t<command_type>::serialize() const {
+    std::string result;
+    for (auto &command: commands) result.append(command.serialize());
+
+    // terminate batch with noop command
+    header_t hdr(0, 0, 0, opaque + static_cast<uint32_t>(commands.size()));
+    hdr.opcode = api::noop_code;
+    hdr.prepare_serialization();
+    result.append(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+    return result;
+}
+
+template class multi_command_t<api::getkq_t>;
+template class multi_command_t<api::setq_t>;
+template class multi_command_t<api::addq_t>;
+template class multi_command_t<api::deleteq_t>;
+
 } // namespace bin
 } // namespace proto
 } // namespace mc
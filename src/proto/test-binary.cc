@@ -227,6 +227,11 @@ struct packet_t {
 
     packet_t(bool): data("bbbbbbbbbbbbbbbbbbbbbbbb") {}
 
+    packet_t &opaque(uint32_t value) {
+        as<uint32_t>(&data[12]) = htonl(value);
+        return *this;
+    }
+
     template <typename type_t>
     type_t &as(char *ptr) const {
         return *reinterpret_cast<type_t *>(ptr);
@@ -485,6 +490,102 @@ bool get_command_found() {
     return connection.empty();
 }
 
+bool get_multi_command_found() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    // prepare request and response
+    api::get_multi_t command(std::vector<std::string>{"1", "2", "3"});
+    std::string request = packet_t(0x0d, 0, "1").opaque(0).data
+                        + packet_t(0x0d, 0, "2").opaque(1).data
+                        + packet_t(0x0d, 0, "3").opaque(2).data
+                        + packet_t(0x0a, 0, "").opaque(3).data;
+    std::string response
+        = packet_t(0x0d, 0x00, 0, "1", "3233", "abc").opaque(0).data
+        + packet_t(0x0d, 0x00, 7, "3", "3233", "def").opaque(2).data
+        + packet_t(0x0a, 0x00, 0).opaque(3).data;
+    validation_connection_t connection(request, response);
+
+    // execute command
+    try {
+        command_parser_t parser(connection);
+        api::get_multi_t::response_t response = parser.send(command);
+        if (!response) return false;
+        if (response.items.size() != 2) return false;
+        if (response.items[0].key != "1") return false;
+        if (response.items[0].data() != "abc") return false;
+        if (response.items[1].key != "3") return false;
+        if (response.items[1].data() != "def") return false;
+        if (response.items[1].cas != 7) return false;
+    } catch (const std::exception &) { return false;}
+    return connection.empty();
+}
+
+bool get_multi_command_bad_opaque() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    // prepare request and response
+    api::get_multi_t command(std::vector<std::string>{"1"});
+    std::string request = packet_t(0x0d, 0, "1").opaque(0).data
+                        + packet_t(0x0a, 0, "").opaque(1).data;
+    packet_t response(0x0d, 0x00, 0, "1", "3233", "abc");
+    response.opaque(3);
+    validation_connection_t connection(request, response);
+
+    // execute command
+    try {
+        command_parser_t parser(connection);
+        if (parser.send(command).code() != mc::proto::resp::invalid)
+            return false;
+    } catch (const std::exception &) { return false;}
+    return true;
+}
+
+bool get_multi_command_shifted_opaque() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    // prepare request and response
+    api::get_multi_t command(std::vector<std::string>{"1", "2"});
+    command.set_opaque(0xfffffffe);
+    std::string request = packet_t(0x0d, 0, "1").opaque(0xfffffffe).data
+                        + packet_t(0x0d, 0, "2").opaque(0xffffffff).data
+                        + packet_t(0x0a, 0, "").opaque(0).data;
+    std::string response
+        = packet_t(0x0d, 0x00, 0, "2", "3233", "abc").opaque(0xffffffff).data
+        + packet_t(0x0a, 0x00, 0).opaque(0).data;
+    validation_connection_t connection(request, response);
+
+    // execute command
+    try {
+        command_parser_t parser(connection);
+        api::get_multi_t::response_t response = parser.send(command);
+        if (!response) return false;
+        if (response.items.size() != 1) return false;
+        if (response.items[0].key != "2") return false;
+        if (response.items[0].data() != "abc") return false;
+    } catch (const std::exception &) { return false;}
+    return (command.opaques() == 3) && connection.empty();
+}
+
+bool get_command_response_opaque() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    // prepare request and response
+    api::get_t command("1");
+    command.set_opaque(7);
+    std::string request = packet_t(0x00, 0, "1").opaque(7).data;
+    packet_t response(0x00, 0x00, 0, "", "3233", "abc");
+    response.opaque(7);
+    validation_connection_t connection(request, response);
+
+    // execute command
+    try {
+        if (api::get_t::response_opaque(response.data) != 7) return false;
+        command_parser_t parser(connection);
+        if (parser.send(command).data() != "abc") return false;
+    } catch (const std::exception &) { return false;}
+    return connection.empty();
+}
+
 bool get_command_found_without_extras() {
     std::cout << __PRETTY_FUNCTION__ << ": ";
 
@@ -628,6 +729,61 @@ bool set_command_ok() {
     return connection.empty();
 }
 
+bool set_multi_command_failure() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    // prepare request and response
+    typedef std::pair<std::string, std::string> item_t;
+    std::vector<item_t> items = {{"1", "abc"}, {"2", "def"}};
+    api::set_multi_t command(items,
+                             mc::proto::opts_t(0x0badcafes, 0xcafebabe));
+    std::string request
+        = packet_t(0x11, 0, "1", "\xca\xfe\xba\xbe\x0b\xad\xca\xfe", "abc")
+              .opaque(0).data
+        + packet_t(0x11, 0, "2", "\xca\xfe\xba\xbe\x0b\xad\xca\xfe", "def")
+              .opaque(1).data
+        + packet_t(0x0a, 0, "").opaque(2).data;
+    std::string response
+        = packet_t(0x11, 0x03, 0, "", "", "Too large.").opaque(1).data
+        + packet_t(0x0a, 0x00, 0).opaque(2).data;
+    validation_connection_t connection(request, response);
+
+    // execute command
+    try {
+        command_parser_t parser(connection);
+        api::set_multi_t::response_t response = parser.send(command);
+        if (!response) return false;
+        if (response.items.size() != 1) return false;
+        if (response.items[0].key != "2") return false;
+        if (response.items[0].code() != mc::proto::resp::server_error)
+            return false;
+        if (response.items[0].data() != "Too large.") return false;
+    } catch (const std::exception &) { return false;}
+    return connection.empty();
+}
+
+bool delete_multi_command_ok() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    // prepare request and response
+    api::delete_multi_t command(std::vector<std::string>{"1", "2"});
+    std::string request = packet_t(0x14, 0, "1").opaque(0).data
+                        + packet_t(0x14, 0, "2").opaque(1).data
+                        + packet_t(0x0a, 0, "").opaque(2).data;
+    packet_t response(0x0a, 0x00, 0);
+    response.opaque(2);
+    validation_connection_t connection(request, response);
+
+    // execute command
+    try {
+        command_parser_t parser(connection);
+        api::delete_multi_t::response_t response = parser.send(command);
+        if (!response) return false;
+        if (!response.items.empty()) return false;
+    } catch (const std::exception &) { return false;}
+    return connection.empty();
+}
+
 bool set_command_not_stored() {
     std::cout << __PRETTY_FUNCTION__ << ": ";
 
@@ -1106,6 +1262,26 @@ bool flush_all_command_ok() {
     return connection.empty();
 }
 
+bool version_command_ok() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    // prepare request and response
+    api::version_t command;
+    packet_t request(11, 0, "");
+    packet_t response(11, 0x00, 0, "", "", "1.6.21");
+    validation_connection_t connection(request, response);
+
+    // execute command
+    try {
+        command_parser_t parser(connection);
+        auto result = parser.send(command);
+        if ((result.code() != mc::proto::resp::ok)
+            || (result.data() != "1.6.21"))
+            return false;
+    } catch (const std::exception &) { return false;}
+    return connection.empty();
+}
+
 class Checker_t {
 public:
     Checker_t(): fails() {}
@@ -1144,12 +1320,18 @@ int main(int, char **) {
     check(test::get_command_found_with_key());
     check(test::get_command_found_flags());
     check(test::get_command_gets());
+    check(test::get_multi_command_found());
+    check(test::get_multi_command_bad_opaque());
+    check(test::get_multi_command_shifted_opaque());
+    check(test::get_command_response_opaque());
 
     // storage
     check(test::set_command_empty());
     check(test::set_command_unrecognized());
     check(test::set_command_error());
     check(test::set_command_ok());
+    check(test::set_multi_command_failure());
+    check(test::delete_multi_command_ok());
     check(test::set_command_not_stored());
     check(test::set_command_not_found());
     check(test::set_command_exists());
@@ -1184,6 +1366,9 @@ int main(int, char **) {
     check(test::flush_all_command_error());
     check(test::flush_all_command_ok());
 
+    // version
+    check(test::version_command_ok());
+
     return check.fails;
 }
 
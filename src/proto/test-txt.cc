@@ -328,6 +328,54 @@ bool get_command_gets() {
     return connection.empty();
 }
 
+bool get_multi_command_found() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    // prepare request and responses
+    api::get_multi_t command(std::vector<std::string>{"1", "2", "3"});
+    const char request[] = "get 1 2 3\r\n";
+    validation_connection_t connection(request, "END\r\n");
+    connection.responses.push_back("def\r\n");
+    connection.responses.push_back("VALUE 3 0 3\r\n");
+    connection.responses.push_back("abc\r\n");
+    connection.responses.push_back("VALUE 1 12345 3\r\n");
+
+    // execute command
+    try {
+        command_parser_t parser(connection);
+        api::get_multi_t::response_t response = parser.send(command);
+        if (!response) return false;
+        if (response.items.size() != 2) return false;
+        if (response.items[0].key != "1") return false;
+        if (response.items[0].data() != "abc") return false;
+        if (response.items[0].flags != 12345) return false;
+        if (response.items[1].key != "3") return false;
+        if (response.items[1].data() != "def") return false;
+    } catch (const std::exception &) { return false;}
+    return connection.empty();
+}
+
+bool get_multi_command_error() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    // prepare request and responses
+    api::gets_multi_t command(std::vector<std::string>{"1", "2"});
+    const char request[] = "gets 1 2\r\n";
+    validation_connection_t connection(request, "SERVER_ERROR out of memory\r\n");
+    connection.responses.push_back("abc\r\n");
+    connection.responses.push_back("VALUE 1 0 3 333\r\n");
+
+    // execute command
+    try {
+        command_parser_t parser(connection);
+        api::gets_multi_t::response_t response = parser.send(command);
+        if (response.code() != mc::proto::resp::server_error) return false;
+        if (response.items.size() != 1) return false;
+        if (response.items[0].cas != 333) return false;
+    } catch (const std::exception &) { return false;}
+    return connection.empty();
+}
+
 bool get_command_invalid_body() {
     std::cout << __PRETTY_FUNCTION__ << ": ";
 
@@ -456,6 +504,66 @@ bool set_command_ok() {
     return connection.empty();
 }
 
+bool add_multi_command_not_stored() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    // prepare request and responses
+    typedef std::pair<std::string, std::string> item_t;
+    std::vector<item_t> items = {{"1", "abc"}, {"2", "def"}};
+    api::add_multi_t command(items, mc::proto::opts_t());
+    const char request[] = "add 1 0 0 3\r\nabc\r\n"
+                           "add 2 0 0 3\r\ndef\r\n"
+                           "version\r\n";
+    validation_connection_t connection(request, "VERSION 1.6.0\r\n");
+    connection.responses.push_back("NOT_STORED\r\n");
+    connection.responses.push_back("STORED\r\n");
+
+    // execute command
+    try {
+        command_parser_t parser(connection);
+        api::add_multi_t::response_t response = parser.send(command);
+        if (!response) return false;
+        if (response.items.size() != 2) return false;
+        if (response.items[0].code() != mc::proto::resp::stored) return false;
+        if (response.items[1].key != "2") return false;
+        if (response.items[1].code() != mc::proto::resp::not_stored)
+            return false;
+    } catch (const std::exception &) { return false;}
+    return connection.empty();
+}
+
+bool set_multi_command_server_error() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    // prepare request and responses
+    typedef std::pair<std::string, std::string> item_t;
+    std::vector<item_t> items = {{"1", "abc"}, {"2", "def"}, {"3", "ghi"}};
+    api::set_multi_t command(items, mc::proto::opts_t());
+    const char request[] = "set 1 0 0 3\r\nabc\r\n"
+                           "set 2 0 0 3\r\ndef\r\n"
+                           "set 3 0 0 3\r\nghi\r\n"
+                           "version\r\n";
+    validation_connection_t connection(request, "VERSION 1.6.0\r\n");
+    connection.responses.push_back("STORED\r\n");
+    connection.responses.push_back("SERVER_ERROR object too large for cache"
+                                   "\r\n");
+    connection.responses.push_back("STORED\r\n");
+
+    // execute command; the error does not break the batch
+    try {
+        command_parser_t parser(connection);
+        api::set_multi_t::response_t response = parser.send(command);
+        if (response.code() != mc::proto::resp::ok) return false;
+        if (response.items.size() != 3) return false;
+        if (response.items[1].key != "2") return false;
+        if (response.items[1].code() != mc::proto::resp::server_error)
+            return false;
+        if (response.items[2].code() != mc::proto::resp::stored)
+            return false;
+    } catch (const std::exception &) { return false;}
+    return connection.empty();
+}
+
 bool set_command_not_stored() {
     std::cout << __PRETTY_FUNCTION__ << ": ";
 
@@ -780,6 +888,26 @@ bool flush_all_command_ok() {
     return connection.empty();
 }
 
+bool version_command_ok() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    // prepare request and response
+    api::version_t command;
+    const char request[] = "version\r\n";
+    const char header[] = "VERSION 1.6.21\r\n";
+    validation_connection_t connection(request, header);
+
+    // execute command
+    try {
+        command_parser_t parser(connection);
+        auto response = parser.send(command);
+        if ((response.code() != mc::proto::resp::ok)
+            || (response.data() != "1.6.21"))
+            return false;
+    } catch (const std::exception &) { return false;}
+    return connection.empty();
+}
+
 class Checker_t {
 public:
     Checker_t(): fails() {}
@@ -819,12 +947,16 @@ int main(int, char **) {
     check(test::get_command_invalid_body());
     check(test::get_command_invalid_flags());
     check(test::get_command_invalid_size());
+    check(test::get_multi_command_found());
+    check(test::get_multi_command_error());
 
     // storage
     check(test::set_command_empty());
     check(test::set_command_unrecognized());
     check(test::set_command_error());
     check(test::set_command_ok());
+    check(test::add_multi_command_not_stored());
+    check(test::set_multi_command_server_error());
     check(test::set_command_not_stored());
     check(test::set_command_not_found());
     check(test::set_command_exists());
@@ -850,6 +982,9 @@ int main(int, char **) {
     check(test::flush_all_command_error());
     check(test::flush_all_command_ok());
 
+    // version
+    check(test::version_command_ok());
+
     return check.fails;
 }
 
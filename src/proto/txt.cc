@@ -19,6 +19,7 @@
  */
 
 #include <sstream>
+#include <functional>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 
@@ -61,13 +62,55 @@ deserialize_value_resp(const std::string &header) {
     // parse and return
     std::istringstream is(header);
     if ((is >> unused) && (is >> unused) && (is >> flags) && (is >> bytes)) {
+        using std::placeholders::_1;
+        using std::placeholders::_2;
+        using std::placeholders::_3;
         is >> cas;
         return response_t(flags, bytes + retrieve_command_t::footer_size, cas,
-                          retrieve_command_t::set_body);
+                          std::bind(retrieve_command_t::set_body, _1, _2, _3,
+                                    retrieve_command_t::footer_size));
     }
     return response_t(resp::syntax, "invalid response: " + header);
 }
 
+/** Parse VALUE response of multi retrieval commands.
+ *
+ *  VALUE <key> <flags> <bytes> [<cas unique>]\r\n
+ */
+static multi_retrieve_command_t::item_t
+deserialize_multi_value_resp(const std::string &header) {
+    // prepare response storage
+    typedef multi_retrieve_command_t::item_t item_t;
+    typedef item_t::parent_t response_t;
+    std::string unused;
+    std::string key;
+    uint32_t flags = 0;
+    std::size_t bytes = 0;
+    uint64_t cas = 0;
+    DBG(DBG1, "Parsing header of multi get command: line=%s",
+              log::escape(header).c_str());
+
+    // parse and return
+    std::istringstream is(header);
+    if ((is >> unused) && (is >> key) && (is >> flags) && (is >> bytes)) {
+        using std::placeholders::_1;
+        using std::placeholders::_2;
+        using std::placeholders::_3;
+        is >> cas;
+        return item_t(key,
+                      response_t(flags,
+                                 bytes + multi_retrieve_command_t::footer_size,
+                                 cas,
+                                 std::bind(retrieve_command_t::set_body,
+                                           _1, _2, _3,
+                                           multi_retrieve_command_t
+                                           ::footer_size)));
+    }
+    return item_t(std::string(),
+                  response_t(resp::syntax, "invalid response: " + header),
+                  true);
+}
+
 } // namespace
 
 command_t::response_t
@@ -125,7 +168,8 @@ std::string retrieve_command_t::serialize(const char *name) const {
 
 void retrieve_command_t::set_body(uint32_t &flags,
                                   std::string &body,
-                                  const std::string &data)
+                                  const std::string &data,
+                                  std::size_t footer_size)
 {
     if (flags & opts_t::compress) {
         body = zlib::uncompress(data, 0, data.size() - footer_size);
@@ -136,6 +180,46 @@ void retrieve_command_t::set_body(uint32_t &flags,
     }
 }
 
+multi_retrieve_command_t::item_t
+multi_retrieve_command_t
+::deserialize_header(const std::string &header, std::size_t) const {
+    typedef item_t::parent_t response_t;
+
+    // reject empty response
+    if (header.empty())
+        return item_t(std::string(), response_t(resp::empty, "empty response"),
+                      true);
+
+    // try parse retrieve responses
+    switch (header[0]) {
+    case 'E':
+        if (boost::starts_with(header, "END"))
+            return item_t(std::string(), response_t(resp::ok), true);
+        break;
+    case 'V':
+        if (boost::starts_with(header, "VALUE"))
+            return deserialize_multi_value_resp(header);
+        break;
+    default: break;
+    }
+
+    // header does not recognized, try global errors (closes the response)
+    return item_t(std::string(),
+                  response_t(command_t::deserialize_header(header)),
+                  true);
+}
+
+std::string multi_retrieve_command_t::serialize(const char *name) const {
+    // get <key>*\r\n
+    std::string result(name);
+    for (auto &key: keys) {
+        aux::check_key(key);
+        result.append(1, ' ').append(key);
+    }
+    result.append(header_delimiter());
+    return result;
+}
+
 storage_command_t::response_t
 storage_command_t::deserialize_header(const std::string &header) const {
     // reject empty response
@@ -274,6 +358,69 @@ std::string flush_all_command_t::serialize() const {
     return os.str();
 }
 
+version_command_t::response_t
+version_command_t::deserialize_header(const std::string &header) const {
+    // reject empty response
+    if (header.empty()) return response_t(resp::empty, "empty response");
+
+    // VERSION <version>\r\n
+    if (boost::starts_with(header, "VERSION "))
+        return response_t(resp::ok, boost::trim_copy(header.substr(8)));
+
+    // there are global errors only
+    return command_t::deserialize_header(header);
+}
+
+std::string version_command_t::serialize() const {
+    return std::string("version") + header_delimiter();
+}
+
+template <typename command_type>
+typename multi_command_t<command_type>::item_t
+multi_command_t<command_type>
+::deserialize_header(const std::string &header, std::size_t index) const {
+    typedef typename item_t::parent_t parent_t;
+
+    // reject empty response
+    if (header.empty())
+        return item_t(std::string(), parent_t(resp::empty, "empty response"),
+                      true);
+
+    // responses of the commands; the client and server errors (e.g. object
+    // too large) belong to the item, the other errors break the stream
+    if (index < commands.size()) {
+        const item_command_t &command = commands[index];
+        parent_t response = command.deserialize_header(header);
+        switch (response.code()) {
+        case resp::client_error:
+        case resp::server_error:
+            return item_t(command.key, response);
+        default:
+            return item_t(command.key, response,
+                          response.code() >= resp::error);
+        }
+    }
+
+    // the version response closes the batch
+    if (boost::starts_with(header, "VERSION"))
+        return item_t(std::string(), parent_t(resp::ok), true);
+    return item_t(std::string(), command_t::deserialize_header(header), true);
+}
+
+template <typename command_type>
+std::string multi_command_t<command_type>::serialize() const {
+    std::string result;
+    for (auto &command: commands) result.append(command.serialize());
+
+    // terminate batch with version command
+    result.append("version").append(header_delimiter());
+    return result;
+}
+
+template class multi_command_t<api::set_t>;
+template class multi_command_t<api::add_t>;
+template class multi_command_t<api::delete_t>;
+
 // command names
 const char *api::get_name = "get";
 const char *api::gets_name = "gets";
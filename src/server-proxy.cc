@@ -44,6 +44,40 @@ void log_server_is_dead(const std::string &srv, uint32_t fail_limit,
                reason.c_str());
 }
 
+void log_server_circuit_open(const std::string &srv,
+                             milliseconds_t backoff,
+                             const std::string &reason)
+{
+    LOG(WARN2, "Circuit breaker opened - probes after backoff: "
+               "name=%s, backoff-ms=%ld, reason=%s",
+               srv.c_str(), backoff.count(), reason.c_str());
+}
+
+void log_server_circuit_closed(const std::string &srv) {
+    LOG(INFO3, "Circuit breaker closed - probes passed and server is alive: "
+               "name=%s", srv.c_str());
+}
+
+void log_server_ejected(const std::string &srv,
+                        milliseconds_t ejection,
+                        microseconds_t average,
+                        microseconds_t median)
+{
+    LOG(WARN2, "Server is ejected for its latency - returns in a few seconds: "
+               "name=%s, ejection-ms=%ld, latency-us=%ld, median-us=%ld",
+               srv.c_str(), ejection.count(), average.count(), median.count());
+}
+
+void log_server_returned(const std::string &srv) {
+    LOG(INFO3, "Ejection expired - server is back in rotation: name=%s",
+        srv.c_str());
+}
+
+void log_server_probed(const std::string &srv) {
+    LOG(INFO3, "Health check passed - server is alive again: name=%s",
+        srv.c_str());
+}
+
 std::string make_state_string(const std::string &srv,
                               std::size_t connections,
                               seconds_t restoration_interval,
@@ -0,0 +1,315 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Test program for libmcache: async client tests.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <iostream>
+#include <exception>
+#include <functional>
+#include <future>
+#include <thread>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/asio/read.hpp>
+
+#include <mcache/init.h>
+#include <mcache/async.h>
+#include <mcache/hash.h>
+#include <mcache/proto/txt.h>
+#include <mcache/proto/binary.h>
+#include <mcache/proto/parser.h>
+#include <mcache/server-proxy.h>
+#include <mcache/server-proxies.h>
+#include <mcache/pool/consistent-hashing.h>
+#include <mcache/io/connections.h>
+#include <mcache/io/buffer.h>
+#include <mcache/io/async-connection.h>
+#include <mcache/io/reactor.h>
+
+namespace test {
+
+/** Connection that responds immediately with canned txt response. The
+ * servers with name starting by "dead" fail.
+ */
+class fake_async_connection_t {
+public:
+    typedef std::function<bool (mc::io::buffer_t &)> reader_t;
+    typedef std::function<void (std::exception_ptr)> handler_t;
+
+    fake_async_connection_t(const std::string &addr, const mc::io::opts_t &)
+        : addr(addr)
+    {}
+
+    void send(std::string, reader_t reader, handler_t handler) {
+        if (addr.compare(0, 4, "dead") == 0) {
+            return handler(std::make_exception_ptr(
+                        mc::io::error_t(mc::io::err::io_error, "fake")));
+        }
+        // the response comes in two parts
+        std::string data = "VALUE key 0 3\r\nab";
+        try {
+            mc::io::buffer_t buffer(data);
+            reader(buffer);
+            return handler(std::make_exception_ptr(std::runtime_error("")));
+        } catch (const mc::io::incomplete_t &) {}
+        data += "c\r\nEND\r\n";
+        mc::io::buffer_t buffer(data);
+        reader(buffer);
+        handler(nullptr);
+    }
+
+    bool is_broken() const { return false;}
+
+    std::string addr;
+};
+
+typedef mc::server_proxy_t<
+            mc::thread::lock_t,
+            mc::io::shared_connection_pool_t<fake_async_connection_t>
+        > server_proxy_t;
+typedef mc::server_proxies_t<
+            mc::thread::shared_array_t,
+            server_proxy_t
+        > server_proxies_t;
+typedef mc::async_client_template_t<
+            mc::consistent_hashing_pool_t<mc::murmur3_t>,
+            server_proxies_t,
+            mc::proto::txt::api
+        > client_t;
+
+bool async_get_future() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    client_t client({"server1:11211", "server2:11211"});
+    auto result = client.get("key").get();
+    return result.found && (result.data == "abc") && !client.in_flight();
+}
+
+bool async_get_callback_failover() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    client_t client({"dead1:11211", "server2:11211"});
+    int found = 0;
+    for (int i = 0; i < 20; ++i) {
+        client.get("key" + std::to_string(i),
+                   [&] (std::exception_ptr error, mc::result_t result) {
+            if (!error && result.found) ++found;
+        });
+    }
+    return found == 20;
+}
+
+bool async_get_out_of_servers() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    client_t client({"dead1:11211", "dead2:11211"});
+    try {
+        client.get("key").get();
+    } catch (const mc::out_of_servers_t &) {
+        return !client.in_flight();
+    }
+    return false;
+}
+
+bool async_bad_key() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    client_t client({"server1:11211"});
+    try {
+        client.get("bad key");
+    } catch (const mc::error_t &) {
+        return !client.in_flight();
+    }
+    return false;
+}
+
+/** Reads count of bin requests and responds them in reverse order. The
+ * value of each key is the key itself; the keys starting by "big" get the
+ * value too large error.
+ */
+void reversing_server(boost::asio::ip::tcp::acceptor &acceptor,
+                      std::size_t count)
+{
+    auto socket = acceptor.accept();
+    std::vector<std::string> responses;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string header(24, '\0');
+        boost::asio::read(socket, boost::asio::buffer(&header[0], 24));
+        std::size_t body_len = (std::size_t(uint8_t(header[10])) << 8)
+                             | std::size_t(uint8_t(header[11]));
+        std::string key(body_len, '\0');
+        boost::asio::read(socket, boost::asio::buffer(&key[0], body_len));
+
+        // magic, opcode, no key, 4B extras, ok, body len, same opaque, cas
+        std::string response = header;
+        response[0] = char(0x81);
+        response[2] = response[3] = response[6] = response[7] = '\0';
+        response[4] = 4;
+        response[11] = char(body_len + 4);
+        std::fill(response.begin() + 16, response.end(), '\0');
+        if (key.compare(0, 3, "big") == 0) {
+            // no extras, status 0x0003 and error message as value
+            std::string message = "Too large.";
+            response[4] = '\0';
+            response[7] = 3;
+            response[11] = char(message.size());
+            responses.push_back(response + message);
+            continue;
+        }
+        responses.push_back(response + std::string(4, '\0') + key);
+    }
+    for (auto iresponse = responses.rbegin(); iresponse != responses.rend();
+         ++iresponse)
+        boost::asio::write(socket, boost::asio::buffer(*iresponse));
+}
+
+bool pipelined_routing_by_opaque() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    using boost::asio::ip::tcp;
+    boost::asio::io_context context;
+    tcp::acceptor acceptor(context, tcp::endpoint(tcp::v4(), 0));
+    std::string addr = "127.0.0.1:"
+                     + std::to_string(acceptor.local_endpoint().port());
+    std::thread server(reversing_server, std::ref(acceptor), 2);
+
+    typedef mc::proto::bin::api::get_t get_t;
+    std::promise<std::string> first, second;
+    {
+        mc::io::tcp::async_connection_t connection(addr, mc::io::opts_t());
+        mc::proto::command_parser_t<mc::io::tcp::async_connection_t>
+            parser(connection);
+        parser.async_send(get_t("first"), [&] (get_t::response_t &&res) {
+            first.set_value(res.data());
+        });
+        parser.async_send(get_t("second"), [&] (get_t::response_t &&res) {
+            second.set_value(res.data());
+        });
+        server.join();
+        if (first.get_future().get() != "first") return false;
+        if (second.get_future().get() != "second") return false;
+    }
+    return true;
+}
+
+bool pipelined_error_reply() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    using boost::asio::ip::tcp;
+    boost::asio::io_context context;
+    tcp::acceptor acceptor(context, tcp::endpoint(tcp::v4(), 0));
+    std::string addr = "127.0.0.1:"
+                     + std::to_string(acceptor.local_endpoint().port());
+    std::thread server(reversing_server, std::ref(acceptor), 3);
+
+    // the error reply arrives between the replies of its neighbours
+    typedef mc::proto::bin::api::get_t get_t;
+    std::promise<get_t::response_t> first, big, last;
+    {
+        mc::io::tcp::async_connection_t connection(addr, mc::io::opts_t());
+        mc::proto::command_parser_t<mc::io::tcp::async_connection_t>
+            parser(connection);
+        parser.async_send(get_t("first"), [&] (get_t::response_t &&res) {
+            first.set_value(std::move(res));
+        });
+        parser.async_send(get_t("big"), [&] (get_t::response_t &&res) {
+            big.set_value(std::move(res));
+        });
+        parser.async_send(get_t("last"), [&] (get_t::response_t &&res) {
+            last.set_value(std::move(res));
+        });
+        server.join();
+        if (big.get_future().get().code() != mc::proto::resp::server_error)
+            return false;
+        if (first.get_future().get().data() != "first") return false;
+        if (last.get_future().get().data() != "last") return false;
+    }
+    return true;
+}
+
+bool async_destroy_in_flight() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    typedef mc::server_proxy_t<
+                mc::thread::lock_t,
+                mc::io::shared_connection_pool_t<
+                    mc::io::tcp::async_connection_t
+                >
+            > proxy_t;
+    typedef mc::async_client_template_t<
+                mc::consistent_hashing_pool_t<mc::murmur3_t>,
+                mc::server_proxies_t<mc::thread::shared_array_t, proxy_t>,
+                mc::proto::bin::api
+            > bin_client_t;
+
+    // the connections hold the last reference to the reactor so it is
+    // released by the reactor thread once the connection handlers finish
+    using boost::asio::ip::tcp;
+    boost::asio::io_context context;
+    tcp::acceptor acceptor(context, tcp::endpoint(tcp::v4(), 0));
+    std::string addr = "127.0.0.1:"
+                     + std::to_string(acceptor.local_endpoint().port());
+    int found = 0;
+    for (int i = 0; i < 10; ++i) {
+        std::thread server(reversing_server, std::ref(acceptor), 1);
+        {
+            mc::server_proxy_config_t scfg;
+            scfg.io_opts.reactor = std::make_shared<mc::io::reactor_t>(1);
+            bin_client_t client({addr}, scfg);
+            client.get("key", [&] (std::exception_ptr error,
+                                   mc::result_t result) {
+                if (!error && result.found) ++found;
+            });
+        }
+        server.join();
+    }
+    return found == 10;
+}
+
+class Checker_t {
+public:
+    Checker_t(): fails() {}
+
+    void operator()(bool result) {
+        fails += !result;
+        if (result)
+            std::cout << "[01;32m" << "ok" << "[01;0m" << std::endl;
+        else
+            std::cout << "[01;31m" << "fail" << "[01;0m" << std::endl;
+    }
+
+    int fails;
+};
+
+} // namespace test
+
+int main(int, char **) {
+    mc::init();
+    test::Checker_t check;
+    check(test::async_get_future());
+    check(test::async_get_callback_failover());
+    check(test::async_get_out_of_servers());
+    check(test::async_bad_key());
+    check(test::pipelined_routing_by_opaque());
+    check(test::pipelined_error_reply());
+    check(test::async_destroy_in_flight());
+    return check.fails;
+}
@@ -0,0 +1,154 @@
+/*
+ * FILE             $Id: $
+ *
+ * DESCRIPTION      Test program for libmcache: co_await front-end tests.
+ *
+ * PROJECT          Seznam memcache client.
+ *
+ * LICENSE          See COPYING
+ *
+ * AUTHOR           agent <agent@local>
+ *
+ * Copyright (C) Seznam.cz a.s. 2026
+ * All Rights Reserved
+ *
+ * HISTORY
+ *       2026-10-16 (agent)
+ *                  First draft.
+ */
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <iostream>
+#include <exception>
+#include <functional>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+
+#include <mcache/init.h>
+#include <mcache/awaitable.h>
+
+namespace test {
+
+namespace asio = boost::asio;
+
+/** Connection that responds with canned txt response from other thread.
+ * The servers with name starting by "dead" fail.
+ */
+class fake_async_connection_t {
+public:
+    typedef std::function<bool (mc::io::buffer_t &)> reader_t;
+    typedef std::function<void (std::exception_ptr)> handler_t;
+
+    fake_async_connection_t(const std::string &addr, const mc::io::opts_t &)
+        : addr(addr)
+    {}
+
+    void send(std::string, reader_t reader, handler_t handler) {
+        bool dead = addr.compare(0, 4, "dead") == 0;
+        std::thread([dead, reader, handler] {
+            if (dead) {
+                return handler(std::make_exception_ptr(
+                            mc::io::error_t(mc::io::err::io_error, "fake")));
+            }
+            std::string data = "VALUE key 0 3\r\nabc\r\nEND\r\n";
+            mc::io::buffer_t buffer(data);
+            reader(buffer);
+            handler(nullptr);
+        }).detach();
+    }
+
+    bool is_broken() const { return false;}
+
+    std::string addr;
+};
+
+typedef mc::server_proxy_t<
+            mc::thread::lock_t,
+            mc::io::shared_connection_pool_t<fake_async_connection_t>
+        > server_proxy_t;
+typedef mc::server_proxies_t<
+            mc::thread::shared_array_t,
+            server_proxy_t
+        > server_proxies_t;
+typedef mc::awaitable_client_template_t<
+            mc::consistent_hashing_pool_t<mc::murmur3_t>,
+            server_proxies_t,
+            mc::proto::txt::api
+        > client_t;
+
+bool awaitable_get() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    asio::io_context context;
+    client_t client(context, {"server1:11211", "server2:11211"});
+    bool result = false;
+    asio::co_spawn(context, [&] () -> asio::awaitable<void> {
+        auto res = co_await client.async_get("key");
+        auto thread = std::this_thread::get_id();
+        auto res2 = co_await client.async_get("key2");
+        // the coroutine is resumed by executor thread
+        result = res && (res.data == "abc") && res2
+              && (thread == std::this_thread::get_id());
+    }, asio::detached);
+    context.run();
+    return result;
+}
+
+bool awaitable_out_of_servers() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    asio::io_context context;
+    client_t client(context, {"dead1:11211", "dead2:11211"});
+    bool result = false;
+    asio::co_spawn(context, [&] () -> asio::awaitable<void> {
+        try {
+            co_await client.async_get("key");
+        } catch (const mc::out_of_servers_t &) {
+            result = true;
+        }
+    }, asio::detached);
+    context.run();
+    return result;
+}
+
+bool awaitable_callback_token() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    asio::io_context context;
+    client_t client(context, {"server1:11211"});
+    bool result = false;
+    client.async_get("key", [&] (std::exception_ptr error, mc::result_t res) {
+        result = !error && res;
+    });
+    context.run();
+    return result;
+}
+
+class Checker_t {
+public:
+    Checker_t(): fails() {}
+
+    void operator()(bool result) {
+        fails += !result;
+        if (result)
+            std::cout << "[01;32m" << "ok" << "[01;0m" << std::endl;
+        else
+            std::cout << "[01;31m" << "fail" << "[01;0m" << std::endl;
+    }
+
+    int fails;
+};
+
+} // namespace test
+
+int main(int, char **) {
+    mc::init();
+    test::Checker_t check;
+    check(test::awaitable_get());
+    check(test::awaitable_out_of_servers());
+    check(test::awaitable_callback_token());
+    return check.fails;
+}
@@ -151,6 +151,16 @@ int main(int argc, char **argv) {
 
         if (client.get("three")) throw 3;
         client.get("aaaa").as<int>();
+
+        client.set("one", "1");
+        client.set("two", "2");
+        mc::results_t results = client.get_multi({"one", "two", "three"});
+        if (results.size() != 2) throw 3;
+        if (results.at("two").data != "2") throw 3;
+        if (!client.gets_multi({"one"}).at("one").cas) throw 3;
+        if (!client.set_multi({{"one", "1"}, {"two", "2"}}).empty()) throw 3;
+        if (client.add_multi({{"one", "1"}}).size() != 1) throw 3;
+        if (!client.delete_multi({"one", "two"}).empty()) throw 3;
         //std::cout << client.dump() << std::endl;
 
         {
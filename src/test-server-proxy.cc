@@ -20,15 +20,24 @@
 #include <ctime>
 #include <cstdlib>
 #include <iostream>
+#include <algorithm>
 #include <memory>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <unistd.h>
+#include <sys/wait.h>
 
 #include <mcache/init.h>
 #include <mcache/server-proxy.h>
+#include <mcache/health-checker.h>
+#include <mcache/proto/binary.h>
 
 namespace test {
 
 using std::chrono_literals::operator""s;
 using std::chrono_literals::operator""ms;
+using std::chrono_literals::operator""us;
 
 class fake_command_t {
 public:
@@ -40,6 +49,15 @@ public:
     }
 };
 
+/** Succeeds like the version command.
+ */
+class probe_command_t: public fake_command_t {
+public:
+    response_t deserialize_header(const std::string &) const {
+        return response_t(mc::proto::resp::ok);
+    }
+};
+
 class always_fail_connection_t {
 public:
     template <typename type_t>
@@ -60,6 +78,64 @@ public:
     std::string read(type_t) { return "";}
 };
 
+/** Fails while the failing flag is set.
+ */
+class switchable_connection_t {
+public:
+    template <typename type_t>
+    void write(type_t) {
+        if (failing) throw mc::io::error_t(mc::io::err::internal_error, "fake");
+    }
+    template <typename type_t>
+    std::string read(type_t) { return "";}
+
+    static std::atomic<bool> failing;
+};
+
+std::atomic<bool> switchable_connection_t::failing;
+
+/** Responds bin get requests; the keys starting by "hit" are found and their
+ * value is the key itself. It counts the written requests.
+ */
+class bin_get_connection_t {
+public:
+    void write(const std::string &data) {
+        ++writes;
+        for (std::size_t pos = 0; pos + 24 <= data.size();) {
+            std::string header = data.substr(pos, 24);
+            std::size_t key_len = (std::size_t(uint8_t(header[2])) << 8)
+                                | std::size_t(uint8_t(header[3]));
+            std::string key = data.substr(pos + 24, key_len);
+            pos += 24 + key_len;
+
+            // quiet get does not respond miss
+            bool hit = key.compare(0, 3, "hit") == 0;
+            if (!hit && (header[1] == 0x0d)) continue;
+
+            // magic, no key, 4B extras, status, body len, same opaque, cas
+            std::string response = header;
+            response[0] = char(0x81);
+            response[2] = response[3] = response[6] = response[10] = '\0';
+            response[4] = hit? 4: 0;
+            response[7] = hit || (header[1] == 0x0a)? 0: 1;
+            response[11] = hit? char(key.size() + 4): '\0';
+            std::fill(response.begin() + 16, response.end(), '\0');
+            input += response + (hit? std::string(4, '\0') + key: "");
+        }
+    }
+
+    std::string read(std::size_t bytes) {
+        std::string result = input.substr(0, bytes);
+        input.erase(0, bytes);
+        return result;
+    }
+
+    std::string input;
+    static std::atomic<int> writes;
+};
+
+std::atomic<int> bin_get_connection_t::writes;
+
 template <typename connection_t>
 class connections_t {
 public:
@@ -190,6 +266,237 @@ bool server_proxy_not_recover_bad_connection() {
     return true;
 }
 
+bool server_proxy_batch_gets() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    typedef mc::server_proxy_t<
+                mc::thread::lock_t,
+                connections_t<bin_get_connection_t>
+            > server_proxy_t;
+    typedef mc::proto::bin::api::get_t get_t;
+
+    mc::server_proxy_config_t cfg;
+    cfg.batch_window = 50000us;
+    server_proxy_t::shared_t shared;
+    server_proxy_t proxy("server1:11211", &shared, cfg);
+
+    // concurrent gets are sent in batches
+    std::atomic<int> good(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&, i] {
+            std::string hit = "hit" + std::to_string(i);
+            auto found = proxy.send(get_t(hit));
+            if (found.code() == mc::proto::resp::ok && found.data() == hit)
+                ++good;
+            std::string miss = "miss" + std::to_string(i);
+            auto missing = proxy.send(get_t(miss));
+            if (missing.code() == mc::proto::resp::not_found) ++good;
+        });
+    }
+    for (auto &thread: threads) thread.join();
+    return (good == 16) && (bin_get_connection_t::writes < 16)
+        && !proxy.is_dead();
+}
+
+bool server_proxy_circuit_breaker_rate() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    typedef mc::server_proxy_t<
+                mc::none::lock_t,
+                connections_t<switchable_connection_t>
+            > server_proxy_t;
+
+    mc::server_proxy_config_t cfg;
+    cfg.breaker.window = 10s;
+    cfg.breaker.min_requests = 10;
+    cfg.breaker.failure_rate = 0.5;
+    cfg.breaker.backoff = 100ms;
+    cfg.breaker.jitter = 0;
+    cfg.breaker.probes = 2;
+    server_proxy_t::shared_t shared;
+    server_proxy_t proxy("server1:11211", &shared, cfg);
+
+    // a few failures among successes do not make server dead
+    switchable_connection_t::failing = false;
+    for (int i = 0; i < 10; ++i) proxy.send(fake_command_t());
+    switchable_connection_t::failing = true;
+    for (int i = 0; i < 9; ++i) proxy.send(fake_command_t());
+    if (proxy.is_dead() || !proxy.callable()) return false;
+
+    // half of requests failed so the breaker opens
+    proxy.send(fake_command_t());
+    if (!proxy.is_dead() || proxy.callable()) return false;
+
+    // after backoff the breaker lets two probes through
+    std::this_thread::sleep_for(150ms);
+    if (!proxy.callable() || !proxy.callable() || proxy.callable())
+        return false;
+
+    // both probes have to pass to make the server alive
+    switchable_connection_t::failing = false;
+    proxy.send(fake_command_t());
+    if (!proxy.is_dead()) return false;
+    proxy.send(fake_command_t());
+    return !proxy.is_dead() && proxy.callable();
+}
+
+bool server_proxy_circuit_breaker_backoff() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    typedef mc::server_proxy_t<
+                mc::none::lock_t,
+                connections_t<switchable_connection_t>
+            > server_proxy_t;
+
+    mc::server_proxy_config_t cfg;
+    cfg.breaker.window = 10s;
+    cfg.breaker.min_requests = 1;
+    cfg.breaker.backoff = 100ms;
+    cfg.breaker.jitter = 0;
+    cfg.breaker.probes = 1;
+    server_proxy_t::shared_t shared;
+    server_proxy_t proxy("server1:11211", &shared, cfg);
+
+    // first failure opens the breaker for 100ms
+    switchable_connection_t::failing = true;
+    proxy.send(fake_command_t());
+    if (!proxy.is_dead()) return false;
+    std::this_thread::sleep_for(150ms);
+
+    // failed probe opens the breaker again for 200ms
+    if (!proxy.callable()) return false;
+    proxy.send(fake_command_t());
+    std::this_thread::sleep_for(150ms);
+    if (proxy.callable()) return false;
+    std::this_thread::sleep_for(100ms);
+    return proxy.callable();
+}
+
+bool latency_sketch() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+    mc::latency_t latency;
+    for (int i = 0; i < 990; ++i) latency.record(100us, 0.1);
+    for (int i = 0; i < 10; ++i) latency.record(10000us, 0.1);
+    // the percentiles are off by one bucket (19%) at most
+    auto p50 = latency.percentile(0.5).count();
+    auto p999 = latency.percentile(0.999).count();
+    if ((p50 < 84) || (p50 > 119) || (p999 < 8400) || (p999 > 11900))
+        return false;
+    // the recent samples dominate moving average
+    if (latency.average() < 5000us) return false;
+    latency.decay();
+    if (latency.samples() != 500) return false;
+    latency.reset();
+    return !latency.samples() && (latency.average() == 0us);
+}
+
+bool server_proxy_outlier_ejection() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    typedef mc::server_proxy_t<
+                mc::none::lock_t,
+                connections_t<empty_connection_t>
+            > server_proxy_t;
+
+    // four servers answer in 300us, one in 40ms and one has few samples
+    mc::outlier_ejection_config_t ocfg;
+    ocfg.factor = 5;
+    ocfg.max_ejected = 0.2;
+    std::vector<mc::latency_t> latencies(6);
+    for (std::size_t i = 0; i < latencies.size(); ++i) {
+        auto sample = i == 4? 40000us: 300us;
+        for (int j = 0; j < (i == 5? 10: 100); ++j)
+            latencies[i].record(sample, ocfg.alpha);
+    }
+    std::vector<const mc::latency_t *> servers;
+    for (auto &latency: latencies) servers.push_back(&latency);
+    mc::microseconds_t median;
+    auto outliers = mc::aux::find_outliers(servers, ocfg, median);
+    if ((outliers != std::vector<std::size_t>{4}) || (median != 300us))
+        return false;
+
+    // the limit of ejected servers is already reached
+    servers[0] = nullptr;
+    if (!mc::aux::find_outliers(servers, ocfg, median).empty()) return false;
+
+    // the proxy records latencies and the ejected one is not callable
+    mc::server_proxy_config_t cfg;
+    cfg.outliers = ocfg;
+    server_proxy_t::shared_t shared;
+    server_proxy_t proxy("server1:11211", &shared, cfg);
+    for (int i = 0; i < 10; ++i) proxy.send(fake_command_t());
+    if (proxy.latency().samples() != 10) return false;
+    auto now = std::chrono::system_clock::now();
+    proxy.eject(now + 100ms, median);
+    if (proxy.callable() || proxy.latency().samples()) return false;
+    std::this_thread::sleep_for(150ms);
+    return proxy.callable() && !proxy.is_dead();
+}
+
+bool server_proxy_health_check() {
+    std::cout << __PRETTY_FUNCTION__ << ": ";
+
+    typedef mc::server_proxy_t<
+                mc::none::lock_t,
+                connections_t<switchable_connection_t>
+            > server_proxy_t;
+
+    mc::server_proxy_config_t cfg;
+    cfg.restoration_interval = 0s;
+    server_proxy_t::shared_t shared;
+    server_proxy_t proxy("server1:11211", &shared, cfg);
+
+    // the server stays dead while the probe fails
+    switchable_connection_t::failing = true;
+    proxy.send(fake_command_t());
+    if (!proxy.is_dead()) return false;
+    if (proxy.check_health(probe_command_t(), 100ms)) return false;
+    if (!proxy.is_dead()) return false;
+
+    // the callers leave the dead server to the checker
+    if (proxy.callable()) return false;
+
+    // the checker thread makes it alive once the probe passes
+    switchable_connection_t::failing = false;
+    std::atomic<int> checks(0);
+    {
+        mc::health_checker_t checker(20ms, [&] {
+            ++checks;
+            proxy.check_health(probe_command_t(), 20ms);
+        });
+        std::this_thread::sleep_for(100ms);
+    }
+    if (!checks.load() || proxy.is_dead()) return false;
+
+    // the request path probes again if the checker stops calling
+    switchable_connection_t::failing = true;
+    proxy.send(fake_command_t());
+    if (!proxy.is_dead()) return false;
+    std::this_thread::sleep_for(100ms);
+    return proxy.callable();
+}
+
+bool health_checker_fork() {
+    std::cout << __PRETTY_FUNCTION__ << ": " << std::flush;
+
+    // the child gets own thread that calls the check and stops it cleanly
+    std::atomic<int> checks(0);
+    mc::health_checker_t checker(10ms, [&] { ++checks;});
+    pid_t pid = ::fork();
+    if (pid < 0) return false;
+    if (!pid) {
+        checks = 0;
+        std::this_thread::sleep_for(100ms);
+        bool called = checks.load() > 0;
+        checker.~health_checker_t();
+        ::_exit(called? 0: 1);
+    }
+    int status = 0;
+    if (::waitpid(pid, &status, 0) != pid) return false;
+    return WIFEXITED(status) && !WEXITSTATUS(status) && checks.load();
+}
+
 class Checker_t {
 public:
     Checker_t(): fails() {}
@@ -214,6 +521,13 @@ int main(int, char **) {
     check(test::server_proxy_fail_limit());
     check(test::server_proxy_raise_zombie());
     check(test::server_proxy_not_recover_bad_connection());
+    check(test::server_proxy_batch_gets());
+    check(test::server_proxy_circuit_breaker_rate());
+    check(test::server_proxy_circuit_breaker_backoff());
+    check(test::latency_sketch());
+    check(test::server_proxy_outlier_ejection());
+    check(test::server_proxy_health_check());
+    check(test::health_checker_fork());
     return check.fails;
 }
 
@@ -18,9 +18,15 @@
  *                  First draft.
  */
 
+#include <set>
+#include <algorithm>
 #include <ctime>
+#include <mutex>
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <thread>
+#include <vector>
 #include <iostream>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -31,6 +37,12 @@
 #include <mcache/io/error.h>
 #include <mcache/server-proxy.h>
 #include <mcache/server-proxies.h>
+#include <mcache/pool/consistent-hashing.h>
+#include <mcache/pool/flat-consistent-hashing.h>
+#include <mcache/pool/interned.h>
+#include <mcache/proto/txt.h>
+#include <mcache/client.h>
+#include <mcache/hash.h>
 
 namespace test {
 
@@ -67,6 +79,152 @@ public:
     std::string server_name() const { return "fake-server:11211";}
 };
 
+/** Responds txt get requests by the address of server as value.
+ */
+class address_connection_t {
+public:
+    address_connection_t(const std::string &addr): addr(addr) {}
+    void write(const std::string &) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        input = "VALUE key 0 " + std::to_string(addr.size()) + "\r\n"
+              + addr + "\r\nEND\r\n";
+    }
+    std::string read(const std::string &delimiter) {
+        return read(input.find(delimiter) + delimiter.size());
+    }
+    std::string read(std::size_t bytes) {
+        std::string result = input.substr(0, bytes);
+        input.erase(0, bytes);
+        return result;
+    }
+    std::string addr;
+    std::string input;
+    static std::atomic<int> delay;
+};
+
+std::atomic<int> address_connection_t::delay;
+
+/** Counts created instances, i.e. server proxies.
+ */
+class address_connections_t {
+public:
+    typedef std::shared_ptr<address_connection_t> connection_ptr_t;
+    address_connections_t(const std::string &addr, const mc::io::opts_t &)
+        : addr(addr)
+    { ++created;}
+    connection_ptr_t pick() {
+        return std::make_shared<address_connection_t>(addr);
+    }
+    void push_back(connection_ptr_t) {}
+    void clear() {}
+    std::size_t size() const { return 0;}
+    std::string server_name() const { return addr;}
+    std::string addr;
+    static std::atomic<int> created;
+};
+
+std::atomic<int> address_connections_t::created;
+
+bool sharing_proxies_update_servers() {
+    std::cout << __PRETTY_FUNCTION__ << ": " << std::flush;
+
+    // prepare
+    typedef mc::server_proxy_t<
+                mc::thread::lock_t,
+                address_connections_t
+            > server_proxy_t;
+    typedef mc::server_proxies_t<
+                mc::thread::shared_array_t,
+                server_proxy_t
+            > proxies_t;
+    typedef mc::client_template_t<
+                mc::consistent_hashing_pool_t<mc::murmur3_t>,
+                proxies_t,
+                mc::proto::txt::api
+            > client_t;
+    auto served = [] (client_t &client, const std::string &addr) {
+        for (int i = 0; i < 100; ++i)
+            if (client.get("key" + std::to_string(i)).data == addr) return true;
+        return false;
+    };
+    client_t client({"server1:11211", "server2:11211"});
+    if (!served(client, "server1:11211")) return false;
+
+    // the proxy of remaining server is reused
+    client.update_servers({"server2:11211", "server3:11211"});
+    if (address_connections_t::created != 3) return false;
+    if (served(client, "server1:11211")) return false;
+    if (!served(client, "server3:11211")) return false;
+
+    // commands running while servers are updated get valid responses
+    std::atomic<bool> stop(false);
+    std::atomic<int> invalid(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; !stop; ++j) {
+                auto data = client.get("key" + std::to_string(j)).data;
+                if (data.compare(0, 6, "server") != 0) ++invalid;
+            }
+        });
+    }
+    for (int i = 0; i < 200; ++i) {
+        if (i % 2) client.update_servers({"server2:11211", "server3:11211"});
+        else client.update_servers({"server3:11211", "server4:11211"});
+    }
+    stop = true;
+    for (auto &thread: threads) thread.join();
+    std::string dump = client.dump();
+    return !invalid && (dump.find("server2:11211") != std::string::npos);
+}
+
+bool sharing_load_bounded_loads() {
+    std::cout << __PRETTY_FUNCTION__ << ": " << std::flush;
+
+    // prepare
+    typedef mc::server_proxy_t<
+                mc::thread::lock_t,
+                address_connections_t
+            > server_proxy_t;
+    typedef mc::server_proxies_t<
+                mc::thread::shared_array_t,
+                server_proxy_t
+            > proxies_t;
+    typedef mc::client_template_t<
+                mc::consistent_hashing_pool_t<mc::murmur3_t>,
+                proxies_t,
+                mc::proto::txt::api
+            > client_t;
+    address_connection_t::delay = 5;
+
+    // counts servers that serve the hot key from many threads
+    auto servers = [] (client_t &client) {
+        std::mutex mutex;
+        std::set<std::string> result;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 12; ++i) {
+            threads.emplace_back([&] {
+                for (int j = 0; j < 20; ++j) {
+                    auto data = client.get("hot-key").data;
+                    std::lock_guard<std::mutex> guard(mutex);
+                    result.insert(data);
+                }
+            });
+        }
+        for (auto &thread: threads) thread.join();
+        return result.size();
+    };
+    std::vector<std::string> addresses = {"server1:11211", "server2:11211",
+                                          "server3:11211", "server4:11211"};
+    client_t unbounded(addresses);
+    mc::client_config_t ccfg;
+    ccfg.load_bound = 0.25;
+    client_t bounded(addresses, mc::server_proxy_config_t(), ccfg);
+    std::size_t spread = servers(bounded);
+    address_connection_t::delay = 0;
+    return (servers(unbounded) == 1) && (spread > 1);
+}
+
 bool sharing_dead_server_thread() {
     std::cout << __PRETTY_FUNCTION__ << ": " << std::flush;
 
@@ -175,6 +333,79 @@ bool sharing_lock_ipc() {
     return false;
 }
 
+bool sharing_interned_pool_thread() {
+    std::cout << __PRETTY_FUNCTION__ << ": " << std::flush;
+
+    // prepare
+    typedef mc::flat_consistent_hashing_pool_t<mc::murmur3_t> flat_pool_t;
+    typedef mc::thread::interned_pool_t<flat_pool_t> pool_t;
+    std::vector<std::string> servers;
+    for (int i = 0; i < 10; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    mc::consistent_hashing_pool_config_t cfg;
+    cfg.virtual_nodes = 100;
+
+    // pools with the same config share the ring
+    std::size_t alive = pool_t::registry_t::size();
+    {
+        pool_t pool(servers, cfg);
+        pool_t same(servers, cfg);
+        if (&pool.get() != &same.get()) return false;
+        if (pool_t::registry_t::size() != alive + 1) return false;
+
+        // the others have their own ones
+        pool_t other(servers);
+        if (&pool.get() == &other.get()) return false;
+        servers.pop_back();
+        pool_t fewer(servers, cfg);
+        if (&pool.get() == &fewer.get()) return false;
+        if (pool_t::registry_t::size() != alive + 3) return false;
+
+        // the interned ring is the same as the private one
+        servers.push_back("server9:11211");
+        flat_pool_t flat(servers, cfg);
+        if (!std::equal(flat.begin(), flat.end(), pool.begin(), pool.end()))
+            return false;
+        if (*flat.choose("key") != *pool.choose("key")) return false;
+    }
+
+    // the last user destroys the ring
+    return pool_t::registry_t::size() == alive;
+}
+
+bool sharing_interned_pool_ipc() {
+    std::cout << __PRETTY_FUNCTION__ << ": " << std::flush;
+
+    // prepare
+    typedef mc::flat_consistent_hashing_pool_t<mc::murmur3_t> flat_pool_t;
+    typedef mc::ipc::interned_pool_t<flat_pool_t> pool_t;
+    std::vector<std::string> servers;
+    for (int i = 0; i < 10; ++i)
+        servers.push_back("server" + std::to_string(i) + ":11211");
+    pool_t pool(servers);
+
+    // run
+    pid_t pid = ::fork();
+    if (pid) {
+        // error
+        if (pid < 0) return false;
+
+        // parent
+        int status = 0;
+        if (::wait(&status) != pid) return false;
+        if (WEXITSTATUS(status)) return false;
+
+    } else {
+        // child finds the ring of parent and uses it
+        pool_t same(servers);
+        flat_pool_t flat(servers);
+        if (&pool.get() != &same.get()) ::exit(1);
+        if (*flat.choose("key") != *same.choose("key")) ::exit(1);
+        ::exit(0);
+    }
+    return true;
+}
+
 class Checker_t {
 public:
     Checker_t(): fails() {}
@@ -199,6 +430,10 @@ int main(int, char **) {
     check(test::sharing_lock_thread());
     check(test::sharing_dead_server_ipc());
     check(test::sharing_lock_ipc());
+    check(test::sharing_proxies_update_servers());
+    check(test::sharing_load_bounded_loads());
+    check(test::sharing_interned_pool_thread());
+    check(test::sharing_interned_pool_ipc());
     return check.fails;
 }
 